@@ -23,12 +23,25 @@
 
 #include <cocaine/common.hpp>
 
+#include <cstdint>
+#include <functional>
 #include <system_error>
 
 struct archive;
 
 namespace cocaine { namespace isolate {
 
+struct deploy_stats_t {
+    // Number of files linked from the cache.
+    std::size_t hits;
+
+    // Number of files written to disk.
+    std::size_t misses;
+
+    // Number of bytes not written to disk thanks to cache hits.
+    std::uint64_t saved;
+};
+
 class archive_t {
     const std::unique_ptr<logging::logger_t> m_log;
 
@@ -38,8 +51,30 @@ public:
     archive_t(context_t& context, const std::string& archive);
    ~archive_t();
 
-    void
-    deploy(const std::string& prefix);
+    /// Unpacks the archive into the given prefix.
+    ///
+    /// The archive itself is read and decompressed sequentially, while small regular files are
+    /// written to disk by up to `concurrency` threads in parallel. Large files are streamed to disk
+    /// by the reading thread, so memory usage stays bounded regardless of the archive contents.
+    ///
+    /// If the cache directory is specified, small regular files are content-addressed by their
+    /// data and mode: known ones are hardlinked from the cache instead of being written, new ones
+    /// are hardlinked into the cache after writing. Linked files share the inode of the cached
+    /// one, so their modification time and owner are those of the first deployed copy rather than
+    /// the ones stored in the archive.
+    ///
+    /// The `cancelled` predicate is checked before each entry, unpacking stops with the
+    /// `operation_canceled` error once it returns true.
+    deploy_stats_t
+    deploy(const std::string& prefix,
+           std::size_t concurrency = 1,
+           const std::string& cache = std::string(),
+           std::function<bool()> cancelled = nullptr);
+
+    /// Removes cached files, which are no longer linked into any app, returning their count.
+    static
+    std::size_t
+    collect(const std::string& cache);
 
 public:
     std::string
@@ -23,6 +23,8 @@
 
 #include "cocaine/api/isolate.hpp"
 
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <string>
 
@@ -44,9 +46,24 @@ class process_t:
     const boost::filesystem::path m_working_directory;
     const uint64_t m_kill_timeout;
 
+    // Number of threads writing app files to disk in parallel while spooling.
+    const uint64_t m_spool_concurrency;
+
+    // Content-addressed cache of app files shared between all apps, empty if disabled.
+    const boost::filesystem::path m_spool_cache;
+
+    // Whether slaves are spawned via vfork(2), which doesn't copy the page tables of the runtime
+    // and leaves nothing but async-signal-safe syscalls to the child, instead of fork(2).
+    const bool m_vfork;
+
     // Only used when built with cgroup support
     void* m_cgroup;
 
+    // The latest unpacking thread, which joins its predecessor before starting. Unpacking threads
+    // refer to this isolate, so they are stopped and joined on destruction.
+    std::thread m_spooler;
+    std::atomic<bool> m_stopped;
+
 public:
     process_t(context_t& context, asio::io_service& io_context, const std::string& name, const std::string& type, const dynamic_t& args);
 
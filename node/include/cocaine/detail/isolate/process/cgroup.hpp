@@ -20,6 +20,7 @@
 
 #include <system_error>
 #include <string>
+#include <vector>
 
 #include <cocaine/forwards.hpp>
 
@@ -31,6 +32,10 @@ void destroy_cgroups(void* cgroup_ptr, logging::logger_t& log);
 
 void attach_cgroups(void* cgroup_ptr, logging::logger_t& log);
 
+// Opens the task files of every controller of the cgroup, so that a child which is not allowed to
+// allocate could attach itself by writing "0" into each of them.
+std::vector<int> open_cgroups(void* cgroup_ptr, const char* cgroup_name, logging::logger_t& log);
+
 const char* get_cgroup_error(int code);
 
 } // namespace isolate
@@ -70,6 +70,10 @@ public:
     discard(const std::error_code& ec) override;
 
     auto write(hpack::headers_t headers, const std::string& data) -> void;
+
+    /// Moves the chunk through, which avoids copying it while the dispatch is not bound yet and
+    /// incoming messages are being queued.
+    auto write(hpack::headers_t headers, std::string&& data) -> void;
     auto abort(hpack::headers_t headers, const std::error_code& ec, const std::string& reason) -> void;
     auto close(hpack::headers_t headers) -> void;
 
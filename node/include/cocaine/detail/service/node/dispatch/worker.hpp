@@ -1,5 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+
+#include <boost/optional/optional.hpp>
+
 #include <cocaine/rpc/dispatch.hpp>
 
 #include "cocaine/idl/node.hpp"
@@ -17,6 +22,7 @@ class worker_rpc_dispatch_t:
 {
 public:
     typedef std::function<void(const std::error_code&)> callback_type;
+    typedef std::chrono::high_resolution_clock clock_type;
 
 private:
     typedef io::event_traits<io::worker::rpc::invoke>::upstream_type incoming_tag;
@@ -35,6 +41,11 @@ private:
     /// On close callback.
     callback_type callback;
 
+    /// Time since the clock epoch of the first message received from the worker, zero if none.
+    ///
+    /// Atomic, because it can be read while the mutex is held by the closing handler.
+    std::atomic<clock_type::rep> first_response;
+
     std::mutex mutex;
 
 public:
@@ -47,7 +58,14 @@ public:
     void
     discard(const std::error_code& ec) override;
 
+    /// Returns the time point of the first message received from the worker, if any.
+    boost::optional<clock_type::time_point>
+    responded() const;
+
 private:
+    void
+    respond();
+
     void
     finalize(std::lock_guard<std::mutex>&, const std::error_code& ec = std::error_code());
 };
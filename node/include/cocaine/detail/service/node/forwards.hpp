@@ -23,6 +23,9 @@ class stream_t;
 namespace detail {
 namespace service {
 namespace node {
+
+class crashlog_writer_t;
+
 namespace slave {
 
 class channel_t;
@@ -30,6 +33,8 @@ class control_t;
 class fetcher_t;
 class machine_t;
 class spawn_handle_t;
+class timeout_wheel_t;
+class transitions_t;
 
 struct load_t;
 struct stats_t;
@@ -10,12 +10,15 @@
 #include "cocaine/idl/rpc.hpp"
 
 #include "cocaine/detail/service/node/forwards.hpp"
+#include "cocaine/detail/service/node/slave/balance.hpp"
+#include "util/histogram.hpp"
 
 namespace cocaine {
 namespace detail {
 namespace service {
 namespace node {
 
+using detail::service::node::slave::balance_handler_t;
 using detail::service::node::slave::load_t;
 using detail::service::node::slave::channel_t;
 using detail::service::node::slave::control_t;
@@ -49,7 +52,11 @@ public:
             profile_t profile,
             std::shared_ptr<api::authentication_t> auth,
             asio::io_service& loop,
-            cleanup_handler fn);
+            cleanup_handler fn,
+            balance_handler_t balance,
+            std::shared_ptr<util::histogram_t> responses,
+            std::shared_ptr<crashlog_writer_t> crashlogs,
+            std::shared_ptr<slave::transitions_t> transitions);
     slave_t(const slave_t& other) = delete;
     slave_t(slave_t&&) = default;
 
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+namespace slave {
+
+/// Listeners notified each time either the slave load or its activity changes.
+///
+/// Both callbacks are invoked under the corresponding slave lock, so notifications about the same
+/// slave are never reordered. They must not call back into the slave.
+struct balance_handler_t {
+    std::function<void(std::uint64_t load)> load;
+    std::function<void(bool active)> activity;
+};
+
+}  // namespace slave
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <system_error>
 
+#include "cocaine/detail/service/node/forwards.hpp"
+
 namespace cocaine {
 namespace detail {
 namespace service {
@@ -13,8 +16,10 @@ namespace node {
 namespace slave {
 
 class channel_t : public std::enable_shared_from_this<channel_t> {
+    friend class timeout_wheel_t;
+
 public:
-    typedef std::function<void()> callback_type;
+    typedef std::function<void(std::uint64_t)> handler_type;
     typedef std::chrono::high_resolution_clock::time_point time_point;
 
 private:
@@ -22,23 +27,42 @@ private:
 
     const std::uint64_t id_;
     const time_point birthstamp_;
-    const callback_type callback;
+
+    /// Time point when the channel has been assigned to the slave.
+    const time_point injected_;
+
+    /// The slave is notified directly on close instead of through a bound callback to avoid
+    /// allocating one per channel.
+    const std::shared_ptr<machine_t> slave;
+    const handler_type handler;
 
     std::atomic<int> state;
     bool watched;
     std::mutex mutex;
 
+    /// Intrusive timeout wheel hook, guarded by the wheel's lock.
+    struct {
+        channel_t* prev;
+        channel_t* next;
+        std::size_t slot;
+        std::uint64_t rounds;
+        bool linked;
+    } timeout;
+
 public:
-    std::shared_ptr<const client_rpc_dispatch_t> into_worker;
-    std::shared_ptr<const worker_rpc_dispatch_t> from_worker;
+    std::shared_ptr<client_rpc_dispatch_t> into_worker;
+    std::shared_ptr<worker_rpc_dispatch_t> from_worker;
 
 public:
-    channel_t(std::uint64_t id, time_point birthstamp, callback_type callback);
+    channel_t(std::uint64_t id, time_point birthstamp, std::shared_ptr<machine_t> slave,
+              handler_type handler);
 
     auto id() const noexcept -> std::uint64_t;
 
     auto birthstamp() const -> time_point;
 
+    auto injected() const -> time_point;
+
     auto closed() const -> bool;
 
     auto send_closed() const -> bool;
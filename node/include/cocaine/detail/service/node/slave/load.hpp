@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include <cocaine/trace/trace.hpp>
@@ -15,6 +16,8 @@ namespace slave {
 using cocaine::service::node::app::event_t;
 
 struct load_t {
+    typedef std::chrono::high_resolution_clock::time_point time_point;
+
     /// Event to be processed.
     event_t event;
 
@@ -26,6 +29,11 @@ struct load_t {
 
     /// An RX stream provided from user. The slave will call its callbacks on every incoming event.
     std::shared_ptr<api::stream_t> downstream;
+
+    /// Time point after which the event is considered expired.
+    ///
+    /// Calculated once on enqueue as the earliest of the request timeout and the event deadline.
+    time_point deadline;
 };
 
 }  // namespace slave
@@ -1,10 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <string>
 #include <system_error>
-
-#include <boost/circular_buffer.hpp>
+#include <utility>
 
 #include <asio/deadline_timer.hpp>
 #include <asio/io_service.hpp>
@@ -24,6 +25,10 @@
 #include "cocaine/service/node/slave/id.hpp"
 
 #include "cocaine/detail/service/node/forwards.hpp"
+#include "cocaine/detail/service/node/slave/balance.hpp"
+#include "util/histogram.hpp"
+#include "util/pool.hpp"
+#include "util/ring.hpp"
 #include "util/splitter.hpp"
 
 namespace cocaine {
@@ -32,6 +37,7 @@ namespace service {
 namespace node {
 namespace slave {
 
+using util::line_ring_t;
 using util::splitter_t;
 
 using cocaine::service::node::slave::id_t;
@@ -80,24 +86,64 @@ private:
     /// The flag means that the overseer has been destroyed and we shouldn't call the callback.
     std::atomic<bool> closed;
     cleanup_handler cleanup;
+    balance_handler_t balance;
+
+    /// Time from the channel assignment until the first response from the worker, shared with the
+    /// engine.
+    std::shared_ptr<util::histogram_t> responses;
+
+    /// Uploads the output on abnormal shutdown, shared between all slaves of the app.
+    std::shared_ptr<crashlog_writer_t> crashlogs;
+
+    /// State transitions recorder, shared between all slaves of the app.
+    std::shared_ptr<transitions_t> transitions;
 
     synchronized<splitter_t> splitter;
-    boost::circular_buffer<std::string> lines;
+
+    /// The most recent output lines to be dumped into the crashlog, guarded by the splitter lock.
+    line_ring_t lines;
 
     std::atomic<bool> shutdowned;
 
     synchronized<std::shared_ptr<state_t>> state;
 
+    /// Time point of the last state transition, guarded by the state lock.
+    std::chrono::high_resolution_clock::time_point migrated;
+
+    /// Mirrors whether the current state is active to be checked without locking the state.
+    std::atomic<bool> activated;
+
     std::atomic<std::uint64_t> counter;
 
+    /// Number of channels currently being processed.
+    ///
+    /// Mirrors the size of the channels map, but can be read without locking it, which is
+    /// required for cheap load balancing.
+    std::atomic<std::uint64_t> inflight;
+
     typedef std::unordered_map<std::uint64_t, std::shared_ptr<channel_t>> channels_map_t;
-    typedef std::unordered_map<std::uint64_t, std::shared_ptr<asio::deadline_timer>> timers_map_t;
+    typedef std::deque<std::pair<std::uint64_t, std::chrono::high_resolution_clock::time_point>> births_t;
 
     struct {
         synchronized<channels_map_t> channels;
-        synchronized<timers_map_t> timers;
+
+        /// Ids and birthstamps of channels in the injection order, so the longest running one is at
+        /// the front.
+        ///
+        /// Revoked channels are dropped lazily, once they reach the front or the queue grows twice
+        /// as large as the channels map. Guarded by the channels lock.
+        births_t births;
     } data;
 
+    /// Tracks request timeouts of all channels using a single timer.
+    std::shared_ptr<timeout_wheel_t> timeouts;
+
+    /// Per-slave caches for objects allocated on each request.
+    struct {
+        std::shared_ptr<util::block_pool_t> channels;
+        std::shared_ptr<util::block_pool_t> dispatches;
+    } pools;
+
     typedef std::chrono::high_resolution_clock clock_type;
 
     clock_type::time_point birthstamp;
@@ -128,7 +174,11 @@ public:
               profile_t profile,
               std::shared_ptr<api::authentication_t> auth,
               asio::io_service& loop,
-              cleanup_handler cleanup);
+              cleanup_handler cleanup,
+              balance_handler_t balance,
+              std::shared_ptr<util::histogram_t> responses,
+              std::shared_ptr<crashlog_writer_t> crashlogs,
+              std::shared_ptr<transitions_t> transitions);
 
     ~machine_t();
 
@@ -189,7 +239,11 @@ private:
     shutdown(std::error_code ec);
 
     void
-    revoke(std::uint64_t id, channel_handler handler);
+    revoke(std::uint64_t id, const channel_handler& handler);
+
+    /// Drops births of revoked channels. Must be called under the channels lock.
+    void
+    prune(const channels_map_t& channels);
 
     void
     dump();
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <asio/deadline_timer.hpp>
+#include <asio/io_service.hpp>
+
+#include "cocaine/detail/service/node/forwards.hpp"
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+namespace slave {
+
+/// Hashed timing wheel, which tracks timeouts of all slave's channels using a single timer.
+///
+/// Channels are linked into wheel slots intrusively, so both scheduling and cancellation are O(1)
+/// and allocation-free. Timeouts are rounded up to the wheel resolution. The timer ticks only while
+/// there is at least one channel tracked.
+///
+/// On expiration both channel's dispatches are discarded with the timeout error.
+class timeout_wheel_t : public std::enable_shared_from_this<timeout_wheel_t> {
+    typedef std::chrono::milliseconds duration_type;
+
+    std::mutex mutex;
+
+    asio::deadline_timer timer;
+    const duration_type resolution;
+
+    /// Heads of intrusive doubly-linked channel lists.
+    std::vector<channel_t*> slots;
+    std::size_t cursor;
+
+    /// Number of tracked channels.
+    std::size_t size;
+    bool ticking;
+
+    /// Dispatches of expired channels, collected under the lock and discarded after it is
+    /// released, because discarding may revoke the channel and get back into the wheel.
+    ///
+    /// Accessed only from the timer completion handler, reused to avoid allocations.
+    std::vector<std::pair<std::shared_ptr<client_rpc_dispatch_t>, std::shared_ptr<worker_rpc_dispatch_t>>> expired;
+
+public:
+    timeout_wheel_t(asio::io_service& loop, duration_type resolution, std::size_t size);
+
+    /// Starts tracking the timeout of the given channel.
+    ///
+    /// \pre the channel must not be tracked already.
+    /// \pre both channel's dispatches must be set.
+    auto schedule(channel_t& channel, duration_type timeout) -> void;
+
+    /// Stops tracking the timeout of the given channel if any.
+    auto cancel(channel_t& channel) -> void;
+
+    /// Stops tracking all channels and cancels the timer, breaking the cyclic reference.
+    auto clear() -> void;
+
+private:
+    auto link(channel_t& channel, std::size_t slot) -> void;
+    auto unlink(channel_t& channel) -> void;
+
+    auto start(std::lock_guard<std::mutex>& lock) -> void;
+    auto on_tick(const std::error_code& ec) -> void;
+};
+
+}  // namespace slave
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
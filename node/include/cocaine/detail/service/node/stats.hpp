@@ -2,8 +2,11 @@
 
 #include <atomic>
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 #include <metrics/accumulator/decaying/exponentially.hpp>
+#include <metrics/gauge.hpp>
 #include <metrics/meter.hpp>
 #include <metrics/timer.hpp>
 #include <metrics/usts/ewma.hpp>
@@ -11,6 +14,8 @@
 #include <cocaine/forwards.hpp>
 #include <cocaine/locked_ptr.hpp>
 
+#include "util/histogram.hpp"
+
 namespace cocaine {
 
 struct stats_t {
@@ -23,6 +28,9 @@ struct stats_t {
 
         /// Number of requests, that were rejected due to queue overflow or other circumstances.
         metrics::shared_metric<std::atomic<std::int64_t>> rejected;
+
+        /// Number of requests, that were proactively dropped from the queue after their deadline.
+        metrics::shared_metric<std::atomic<std::int64_t>> expired;
     } requests;
 
     struct {
@@ -31,8 +39,36 @@ struct stats_t {
 
         /// Number of crashed slaves.
         metrics::shared_metric<std::atomic<std::int64_t>> crashed;
+
+        /// Number of slaves sealed after reaching one of the recycling limits.
+        metrics::shared_metric<std::atomic<std::int64_t>> recycled;
     } slaves;
 
+    struct {
+        /// Number of events queue rebalancing passes.
+        metrics::shared_metric<std::atomic<std::int64_t>> invocations;
+
+        /// Number of rebalancing requests merged into an already scheduled pass.
+        metrics::shared_metric<std::atomic<std::int64_t>> coalesced;
+
+        /// Number of events moved from the queue to slaves.
+        metrics::shared_metric<std::atomic<std::int64_t>> moved;
+    } rebalance;
+
+    struct crashlogs_t {
+        /// Number of crashlogs saved into the storage.
+        metrics::shared_metric<std::atomic<std::int64_t>> written;
+
+        /// Number of crashlogs the storage has failed to save.
+        metrics::shared_metric<std::atomic<std::int64_t>> failed;
+
+        /// Number of crashlogs dropped due to the upload queue overflow.
+        metrics::shared_metric<std::atomic<std::int64_t>> dropped;
+
+        /// Number of crashlogs dropped as duplicates of recently uploaded ones.
+        metrics::shared_metric<std::atomic<std::int64_t>> deduplicated;
+    } crashlogs;
+
     /// EWMA rates.
     metrics::shared_metric<metrics::meter_t> meter;
     std::shared_ptr<metrics::usts::ewma_t> queue_depth;
@@ -41,6 +77,23 @@ struct stats_t {
     /// Channel processing time quantiles (summary).
     metrics::shared_metric<metrics::timer<metrics::accumulator::decaying::exponentially_t>> timer;
 
+    /// Request latency broken down by phases, in microseconds, over the last minute or two.
+    ///
+    /// Shared with slaves, which record worker related phases.
+    struct latency_t {
+        /// Time spent in the queue, from the event birth until its assignment to a slave.
+        util::histogram_t queue;
+
+        /// Time from the assignment until the first response from the worker.
+        util::histogram_t response;
+
+        /// Channel lifetime, from the assignment until both sides are closed.
+        util::histogram_t channel;
+    };
+
+    std::shared_ptr<latency_t> latency;
+    std::vector<metrics::shared_metric<metrics::gauge<double>>> latency_gauges;
+
     stats_t(context_t& context, const std::string& name, std::chrono::high_resolution_clock::duration interval);
 
     auto deregister() -> void;
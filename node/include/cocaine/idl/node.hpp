@@ -173,7 +173,9 @@ struct info {
         expand_manifest = 0x02,
         // Expand current app's profile struct, otherwise only the current profile name will be
         // reported.
-        expand_profile  = 0x04
+        expand_profile  = 0x04,
+        // Report recent slave state transitions and the time spent in each state.
+        state_trace     = 0x08
     };
 
     static const char* alias() {
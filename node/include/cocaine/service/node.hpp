@@ -50,6 +50,12 @@ private:
     // Started applications.
     synchronized<std::map<std::string, std::shared_ptr<node::app_t>>> apps;
 
+    // Polls isolate metrics of all applications at once, null if disabled.
+    std::shared_ptr<node::metrics_poller_t> metrics_poller;
+
+    // Resolves manifests and profiles of starting applications.
+    std::shared_ptr<node::resolver_t> resolver;
+
     // Slot for context signals.
     std::shared_ptr<dispatch<io::context_tag>> signal;
 
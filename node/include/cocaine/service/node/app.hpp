@@ -34,7 +34,9 @@ public:
     app_t(context_t& context,
           const std::string& manifest,
           const std::string& profile,
-          std::function<void(std::future<void> future)> callback);
+          std::function<void(std::future<void> future)> callback,
+          std::shared_ptr<metrics_poller_t> metrics_poller,
+          std::shared_ptr<resolver_t> resolver);
     ~app_t();
 
     std::string
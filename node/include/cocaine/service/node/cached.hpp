@@ -21,6 +21,12 @@
 #ifndef COCAINE_CACHED_HPP
 #define COCAINE_CACHED_HPP
 
+#include <exception>
+#include <functional>
+#include <future>
+
+#include <boost/optional/optional.hpp>
+
 #include <cocaine/api/storage.hpp>
 
 #include <cocaine/context.hpp>
@@ -33,8 +39,22 @@ struct cached:
 {
     enum class sources { cache, storage };
 
+    typedef std::function<void(std::future<cached<T>>)> callback_type;
+
+    /// Blocks until the object is fetched.
     cached(context_t& context, const std::string& collection, const std::string& name);
 
+    /// Wraps an already fetched object.
+    cached(T object, sources source);
+
+    /// Fetches the object without blocking, trying the "cache" storage first and falling back to
+    /// the "core" one, exactly like the blocking constructor does.
+    ///
+    /// The callback is invoked exactly once, usually from within a storage thread.
+    static
+    void
+    fetch(context_t& context, const std::string& collection, const std::string& name, callback_type callback);
+
     T&
     object() {
         return static_cast<T&>(*this);
@@ -54,6 +74,18 @@ private:
     void
     download(context_t& context, const std::string& collection, const std::string& name);
 
+    static
+    void
+    download(context_t& context, const std::string& collection, const std::string& name, callback_type callback);
+
+    static
+    void
+    complete(const callback_type& callback, cached<T> object);
+
+    static
+    void
+    abort(const callback_type& callback, std::exception_ptr error);
+
 private:
     sources m_source;
 };
@@ -91,6 +123,105 @@ cached<T>::download(context_t& context, const std::string& collection, const std
     m_source = sources::storage;
 }
 
+template<class T>
+cached<T>::cached(T object, sources source):
+    T(std::move(object)),
+    m_source(source)
+{}
+
+template<class T>
+void
+cached<T>::fetch(context_t& context, const std::string& collection, const std::string& name,
+                 callback_type callback)
+{
+    api::storage_ptr cache;
+
+    try {
+        cache = api::storage(context, "cache");
+    } catch(const std::system_error& e) {
+        download(context, collection, name, std::move(callback));
+        return;
+    }
+
+    cache->get<T>(collection, name, [=, &context](std::future<T> future) {
+        boost::optional<T> object;
+
+        try {
+            object = future.get();
+        } catch(const std::system_error& e) {
+            download(context, collection, name, [=](std::future<cached<T>> future) {
+                boost::optional<cached<T>> downloaded;
+
+                try {
+                    downloaded = future.get();
+                } catch(...) {
+                    abort(callback, std::current_exception());
+                    return;
+                }
+
+                try {
+                    //Run in background
+                    cache->put(collection, name, downloaded->object(), std::vector<std::string>());
+                } catch(const std::exception&) {
+                    // Populating the cache is best effort only.
+                }
+
+                complete(callback, std::move(*downloaded));
+            });
+
+            return;
+        }
+
+        complete(callback, cached<T>(std::move(*object), sources::cache));
+    });
+}
+
+template<class T>
+void
+cached<T>::download(context_t& context, const std::string& collection, const std::string& name,
+                    callback_type callback)
+{
+    api::storage_ptr storage;
+
+    try {
+        storage = api::storage(context, "core");
+    } catch(...) {
+        abort(callback, std::current_exception());
+        return;
+    }
+
+    // Intentionally propagate storage exceptions through the callback. The storage is captured
+    // to keep it alive until the callback has run.
+    storage->get<T>(collection, name, [storage, callback](std::future<T> future) {
+        boost::optional<T> object;
+
+        try {
+            object = future.get();
+        } catch(...) {
+            abort(callback, std::current_exception());
+            return;
+        }
+
+        complete(callback, cached<T>(std::move(*object), sources::storage));
+    });
+}
+
+template<class T>
+void
+cached<T>::complete(const callback_type& callback, cached<T> object) {
+    std::promise<cached<T>> promise;
+    promise.set_value(std::move(object));
+    callback(promise.get_future());
+}
+
+template<class T>
+void
+cached<T>::abort(const callback_type& callback, std::exception_ptr error) {
+    std::promise<cached<T>> promise;
+    promise.set_exception(std::move(error));
+    callback(promise.get_future());
+}
+
 } // namespace cocaine
 
 #endif
@@ -12,8 +12,10 @@ namespace detail {
 namespace service {
 namespace node {
 
+class metrics_poller_t;
 class metrics_retriever_t;
 class engine_t;
+class resolver_t;
 
 namespace slave {
 
@@ -38,6 +40,8 @@ class overseer_t;
 
 // Reexport.
 using detail::service::node::engine_t;
+using detail::service::node::metrics_poller_t;
+using detail::service::node::resolver_t;
 
 namespace slave {
 
@@ -32,6 +32,9 @@ namespace cocaine {
 struct manifest_t : cached<dynamic_t> {
     manifest_t(context_t& context, const std::string& name);
 
+    /// Parses the already fetched manifest.
+    manifest_t(context_t& context, const std::string& name, cached<dynamic_t> source);
+
     // The application name.
     std::string name;
 
@@ -30,7 +30,8 @@ public:
                manifest_t manifest,
                profile_t profile,
                std::shared_ptr<pool_observer> observer,
-               std::shared_ptr<asio::io_service> loop);
+               std::shared_ptr<asio::io_service> loop,
+               std::shared_ptr<metrics_poller_t> metrics_poller);
 
     /// TODO: Docs.
     ~overseer_t();
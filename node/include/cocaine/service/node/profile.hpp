@@ -22,6 +22,9 @@
 #ifndef COCAINE_ENGINE_PROFILE_HPP
 #define COCAINE_ENGINE_PROFILE_HPP
 
+#include <map>
+#include <string>
+
 #include <cocaine/common.hpp>
 #include <cocaine/context/config.hpp>
 #include <cocaine/dynamic.hpp>
@@ -33,6 +36,9 @@ namespace cocaine {
 struct profile_t : cached<dynamic_t> {
     profile_t(context_t& context, const std::string& name);
 
+    /// Parses the already fetched profile.
+    profile_t(const std::string& name, cached<dynamic_t> source);
+
     // The profile name.
     std::string name;
 
@@ -52,10 +58,70 @@ struct profile_t : cached<dynamic_t> {
     // Limits.
     unsigned long concurrency;
     unsigned long crashlog_limit;
+    unsigned long crashlog_size;
     unsigned long grow_threshold;
     unsigned long pool_limit;
     unsigned long queue_limit;
 
+    // Pending events queue discipline, either "fifo" or "edf" (earliest deadline first).
+    std::string queue_discipline;
+
+    // Interval in seconds between proactive sweeps of expired queued events, zero disables them.
+    double queue_sweep;
+
+    // Maximum age in seconds of a cached info snapshot, zero disables caching.
+    double info_staleness;
+
+    // Uploading of crashlogs into the storage, limited to survive crash storms.
+    struct {
+        // Maximum number of crashlogs waiting to be uploaded, newer ones are dropped.
+        unsigned long queue_limit;
+
+        // Sustained number of crashlogs uploaded per second, zero means unlimited.
+        double rate;
+
+        // Number of crashlogs that can be uploaded at once above the sustained rate.
+        unsigned long burst;
+
+        // Maximum number of concurrent storage writes.
+        unsigned long concurrency;
+
+        // Period in seconds during which identical crashlogs are dropped, zero disables dropping.
+        double dedup_window;
+    } crashlog_upload;
+
+    // Weighted fair queuing of pending events between clients identified by the given header value,
+    // disabled when the header is empty. Clients not listed in weights have the weight of 1.
+    struct {
+        std::string header;
+        std::map<std::string, double> weights;
+    } fair;
+
+    // Warm pool, which is grown ahead of demand when automatic pool policy is used.
+    struct {
+        // Number of spare slaves to keep alive in addition to the current demand.
+        unsigned long spare;
+
+        // Time horizon in seconds to forecast the demand growth for, zero disables forecasting.
+        double horizon;
+    } warm;
+
+    // Proactive recycling of slaves, a replacement is spawned before the slave is sealed. Zero
+    // disables the corresponding limit.
+    struct {
+        // Number of requests a slave serves before it is recycled.
+        unsigned long requests;
+
+        // Slave uptime in seconds after which it is recycled.
+        double uptime;
+
+        // Memory usage in bytes reported by the isolate metrics above which a slave is recycled.
+        unsigned long memory;
+
+        // Interval in seconds between the limits checks.
+        double interval;
+    } recycle;
+
     // Publishing thresholds.
     auto publish_on() const -> std::uint32_t;
     auto unpublish_under() const -> std::uint32_t;
@@ -22,6 +22,7 @@
 #include "cocaine/detail/isolate/archive.hpp"
 #include "cocaine/detail/isolate/fetcher.hpp"
 #include "cocaine/detail/isolate/process/cgroup.hpp"
+#include "cocaine/idl/node.hpp"
 
 #include <cocaine/api/storage.hpp>
 #include <cocaine/context.hpp>
@@ -29,11 +30,21 @@
 #include <cocaine/errors.hpp>
 #include <cocaine/logging.hpp>
 
+#include <metrics/registry.hpp>
+
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include <cassert>
 #include <csignal>
+#include <cstring>
 
 #include <asio/deadline_timer.hpp>
 
@@ -43,8 +54,13 @@
 #include <boost/range/iterator_range.hpp>
 #include <boost/system/system_error.hpp>
 
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <blackhole/logger.hpp>
 #include <blackhole/wrapper.hpp>
 
@@ -55,6 +71,11 @@
 extern char** environ;
 #endif
 
+#if defined(__linux__) && !defined(SYS_close_range)
+// Available since Linux 5.9, the number is shared by all architectures.
+#define SYS_close_range 436
+#endif
+
 namespace cocaine {
 namespace isolate {
 
@@ -237,6 +258,43 @@ private:
     }
 };
 
+// Stops the unpacking and prevents the spool handler from being notified after cancellation.
+class spool_cancellation_t:
+    public api::cancellation_t
+{
+    std::shared_ptr<std::atomic<bool>> cancelled;
+
+public:
+    explicit
+    spool_cancellation_t(std::shared_ptr<std::atomic<bool>> cancelled):
+        cancelled(std::move(cancelled))
+    {}
+
+    virtual
+    void
+    cancel() noexcept {
+        cancelled->store(true);
+    }
+};
+
+// Deploys into the same directory must never overlap, even if made by different isolate instances.
+static std::shared_ptr<std::mutex>
+directory_lock(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<std::mutex>> locks;
+
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto result = locks[path].lock();
+
+    if(!result) {
+        result = std::make_shared<std::mutex>();
+        locks[path] = result;
+    }
+
+    return result;
+}
+
 static void
 closefrom_dir(boost::filesystem::path path) {
     if (!boost::filesystem::is_directory(path)) {
@@ -287,56 +345,157 @@ close_all() {
 #endif
 }
 
+static bool
+is_vfork(const std::string& mode) {
+    if(mode == "fork") {
+        return false;
+    } else if(mode == "vfork") {
+        return true;
+    }
+
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+        cocaine::format("unknown spawn mode '{}'", mode));
 }
 
-process_t::process_t(context_t& context, asio::io_service& io_context, const std::string& name, const std::string& type, const dynamic_t& args):
-    category_type(context, io_context, name, type, args),
-    m_context(context),
-    io_context(io_context),
-    m_log(context.log(name)),
-    m_name(name),
-    m_working_directory(fs::path(args.as_object().at("spool", "/var/spool/cocaine").as_string()) / name),
-    m_kill_timeout(args.as_object().at("kill_timeout", 5ULL).as_uint())
-{
-    m_cgroup = init_cgroups(m_name.c_str(), args, *m_log);
+// Command line and environment of a slave, prepared before forking so that the child could execute
+// it without allocating.
+class command_t {
+    std::vector<std::string> strings;
+    std::vector<char*> argv_;
+    std::vector<char*> envp_;
+
+public:
+    command_t(const fs::path& target, const api::args_t& args, const api::env_t& environment) {
+        strings.push_back(target.native());
+
+        for(auto it = args.begin(); it != args.end(); ++it) {
+            strings.push_back(it->first);
+            strings.push_back(it->second);
+        }
+
+        const auto argc = strings.size();
+
+        for(char** ptr = environ; *ptr != nullptr; ++ptr) {
+            strings.push_back(*ptr);
+        }
+
+        for(auto it = environment.begin(); it != environment.end(); ++it) {
+            strings.push_back(cocaine::format("{}={}", it->first, it->second));
+        }
+
+        // Pointers are taken only after all the strings are in place.
+        for(std::size_t id = 0; id < strings.size(); ++id) {
+            (id < argc ? argv_ : envp_).push_back(&strings[id][0]);
+        }
+
+        argv_.push_back(nullptr);
+        envp_.push_back(nullptr);
+    }
+
+    char**
+    argv() {
+        return argv_.data();
+    }
+
+    char**
+    envp() {
+        return envp_.data();
+    }
+};
+
+// Everything the vforked child needs. The child shares the memory with the parent, which is
+// suspended until the child either executes the slave or exits, so the failure reason is passed
+// back through the same structure.
+struct vfork_context_t {
+    int output;
+    const std::vector<int>& cgroups;
+    int max_fd;
+    const char* directory;
+    command_t& command;
+
+    volatile int error;
+    const char* volatile stage;
+};
+
+static void
+close_from(int first, int max_fd) noexcept {
+#if defined(__linux__)
+    if(::syscall(SYS_close_range, first, ~0U, 0) == 0) {
+        return;
+    }
+#endif
+
+    // Either the kernel is too old or it's not Linux, fallback to closing each descriptor, which
+    // unlike iterating over procfs doesn't require allocations.
+    for(int fd = first; fd < max_fd; ++fd) {
+        ::close(fd);
+    }
 }
 
-process_t::~process_t() {
-    destroy_cgroups(m_cgroup, *m_log);
+static void
+fail_vforked(vfork_context_t& context, const char* stage) noexcept {
+    context.error = errno;
+    context.stage = stage;
+    ::_exit(EXIT_FAILURE);
 }
 
-std::unique_ptr<api::cancellation_t>
-process_t::spool(std::shared_ptr<api::spool_handle_base_t> handler) {
-    COCAINE_LOG_INFO(m_log, "deploying app to {}", m_working_directory);
+// Runs in the vforked child: only async-signal-safe calls, no allocations, no exceptions.
+static void
+exec_vforked(vfork_context_t& context) noexcept {
+    ::dup2(context.output, STDOUT_FILENO);
+    ::dup2(context.output, STDERR_FILENO);
+
+    // Writing zero into a tasks file attaches the calling process.
+    for(int fd : context.cgroups) {
+        if(::write(fd, "0", 1) != 1) {
+            fail_vforked(context, "unable to attach the process to a cgroup");
+        }
+    }
 
-    const auto storage = api::storage(m_context, "core");
+    close_from(3, context.max_fd);
 
-    //TODO: maybe we can change to async, but as far as this isolation is a legacy one there is no need right now
-    const auto archive = storage->get<std::string>("apps", m_name).get();
+    if(::chdir(context.directory) != 0) {
+        fail_vforked(context, "unable to change the working directory");
+    }
 
-    archive_t(m_context, archive).deploy(m_working_directory.native());
-    io_context.post([=](){
-        handler->on_ready();
-    });
-    return std::unique_ptr<api::cancellation_t>(new api::cancellation_t);
-}
+    // Handlers are shared with the parent's memory, so they are reset before unblocking signals,
+    // just like execve would do.
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_DFL;
 
-std::unique_ptr<api::cancellation_t>
-process_t::spawn(const std::string& path,
-            const api::args_t& args,
-            const api::env_t& environment,
-            std::shared_ptr<api::spawn_handle_base_t> handle)
-{
-    std::array<int, 2> pipes;
+    for(int signum = 1; signum < NSIG; ++signum) {
+        struct sigaction current;
 
-    if(::pipe(pipes.data()) != 0) {
-        throw std::system_error(errno, std::system_category(), "unable to create an output pipe");
+        if(::sigaction(signum, nullptr, &current) == 0 && current.sa_handler != SIG_IGN) {
+            ::sigaction(signum, &action, nullptr);
+        }
     }
 
-    for(auto it = pipes.begin(); it != pipes.end(); ++it) {
-        ::fcntl(*it, F_SETFD, FD_CLOEXEC);
+    sigset_t sigset;
+    sigemptyset(&sigset);
+    ::sigprocmask(SIG_SETMASK, &sigset, nullptr);
+
+    ::execve(context.command.argv()[0], context.command.argv(), context.command.envp());
+
+    fail_vforked(context, "unable to execute");
+}
+
+static int
+open_max() {
+    struct rlimit limit;
+
+    if(::getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+        return static_cast<int>(::sysconf(_SC_OPEN_MAX));
     }
 
+    return static_cast<int>(limit.rlim_cur);
+}
+
+static pid_t
+spawn_forked(const std::string& path, command_t& command, const std::array<int, 2>& pipes,
+             void* cgroup, logging::logger_t& log, const fs::path& working_directory)
+{
     const pid_t pid = ::fork();
 
     if(pid < 0) {
@@ -345,28 +504,14 @@ process_t::spawn(const std::string& path,
         throw std::system_error(errno, std::system_category(), "unable to fork");
     }
 
-    ::close(pipes[pid > 0]);
-
     if(pid > 0) {
-        io_context.post([=](){
-            handle->on_ready();
-        });
-        std::unique_ptr<logging::logger_t> fetcher_logger(m_context.log("process_fetcher"));
-        std::unique_ptr<logging::logger_t> terminator_logger(m_context.log("process_terminator"));
-        auto fetcher = std::make_shared<fetcher_t>(io_context, handle, std::move(fetcher_logger));
-        fetcher->assign(pipes[0]);
-        std::unique_ptr<api::cancellation_t> terminator(new process_terminator_t(
-            pid,
-            m_kill_timeout,
-            std::move(terminator_logger),
-            io_context,
-            std::move(fetcher)
-        ));
-        return terminator;
+        return pid;
     }
 
     // Child initialization
 
+    ::close(pipes[0]);
+
     ::dup2(pipes[1], STDOUT_FILENO);
     ::dup2(pipes[1], STDERR_FILENO);
 
@@ -376,60 +521,258 @@ process_t::spawn(const std::string& path,
         std::cerr << format("unable to close all file descriptors: {}", e.what()) << std::endl;
     }
 
-    attach_cgroups(m_cgroup, *m_log);
+    attach_cgroups(cgroup, log);
 
     // Set the correct working directory
 
     try {
-        fs::current_path(m_working_directory);
+        fs::current_path(working_directory);
     } catch(const fs::filesystem_error& e) {
-        std::cerr << cocaine::format("unable to change the working directory to '{}' - {}", m_working_directory, e.what());
+        std::cerr << cocaine::format("unable to change the working directory to '{}' - {}", working_directory, e.what());
         std::_Exit(EXIT_FAILURE);
     }
 
-    // Prepare the command line and the environment
+    // Unblock all the signals
 
-    auto target = fs::path(path);
+    sigset_t sigset;
 
-    if(!target.is_absolute()) {
-        target = m_working_directory / target;
+    sigfillset(&sigset);
+
+    ::sigprocmask(SIG_UNBLOCK, &sigset, nullptr);
+
+    // Spawn the slave
+
+    if(::execve(command.argv()[0], command.argv(), command.envp()) != 0) {
+        std::error_code ec(errno, std::system_category());
+        std::cerr << cocaine::format("unable to execute '{}' - [{}] {}", path, ec.value(), ec.message());
     }
 
-    std::vector<char*> argv = { ::strdup(target.native().c_str()) }, envp;
+    std::_Exit(EXIT_FAILURE);
+}
 
-    for(auto it = args.begin(); it != args.end(); ++it) {
-        argv.push_back(::strdup(it->first.c_str()));
-        argv.push_back(::strdup(it->second.c_str()));
+static pid_t
+spawn_vforked(const std::string& path, command_t& command, const std::array<int, 2>& pipes,
+              void* cgroup, const std::string& name, logging::logger_t& log, const fs::path& working_directory)
+{
+    // Everything which requires allocations is done here, the child only makes syscalls.
+    const auto cgroups = open_cgroups(cgroup, name.c_str(), log);
+
+    vfork_context_t context {
+        pipes[1],
+        cgroups,
+        open_max(),
+        working_directory.c_str(),
+        command,
+        0,
+        nullptr
+    };
+
+    // Block all the signals, otherwise a handler could run in the child on top of the parent's
+    // memory before the handlers are reset.
+    sigset_t sigset, previous;
+    sigfillset(&sigset);
+    ::pthread_sigmask(SIG_SETMASK, &sigset, &previous);
+
+    const pid_t pid = ::vfork();
+
+    if(pid == 0) {
+        exec_vforked(context);
     }
 
-    argv.push_back(nullptr);
+    const int ec = errno;
+
+    ::pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    std::for_each(cgroups.begin(), cgroups.end(), ::close);
+
+    if(pid < 0) {
+        std::for_each(pipes.begin(), pipes.end(), ::close);
 
-    for(char** ptr = environ; *ptr != nullptr; ++ptr) {
-        envp.push_back(::strdup(*ptr));
+        throw std::system_error(ec, std::system_category(), "unable to vfork");
     }
 
-    for(auto it = environment.begin(); it != environment.end(); ++it) {
-        envp.push_back(::strdup(cocaine::format("{}={}", it->first, it->second).c_str()));
+    if(context.error != 0) {
+        // The child has already exited, so it's collected right away.
+        std::for_each(pipes.begin(), pipes.end(), ::close);
+
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+
+        const char* stage = context.stage;
+
+        throw std::system_error(context.error, std::system_category(),
+            cocaine::format("{} '{}'", stage, path));
     }
 
-    envp.push_back(nullptr);
+    return pid;
+}
 
-    // Unblock all the signals
+}
 
-    sigset_t sigset;
+process_t::process_t(context_t& context, asio::io_service& io_context, const std::string& name, const std::string& type, const dynamic_t& args):
+    category_type(context, io_context, name, type, args),
+    m_context(context),
+    io_context(io_context),
+    m_log(context.log(name)),
+    m_name(name),
+    m_working_directory(fs::path(args.as_object().at("spool", "/var/spool/cocaine").as_string()) / name),
+    m_kill_timeout(args.as_object().at("kill_timeout", 5ULL).as_uint()),
+    m_spool_concurrency(std::max<uint64_t>(1, args.as_object().at(
+        "spool_concurrency",
+        static_cast<uint64_t>(std::min(4u, std::max(1u, std::thread::hardware_concurrency())))
+    ).as_uint())),
+    m_spool_cache(args.as_object().at("spool_cache", false).as_bool() ?
+        fs::path(args.as_object().at("spool", "/var/spool/cocaine").as_string()) / ".cache" :
+        fs::path()),
+    m_vfork(is_vfork(args.as_object().at("spawn_mode", "fork").as_string())),
+    m_stopped(false)
+{
+    m_cgroup = init_cgroups(m_name.c_str(), args, *m_log);
+}
 
-    sigfillset(&sigset);
+process_t::~process_t() {
+    m_stopped = true;
 
-    ::sigprocmask(SIG_UNBLOCK, &sigset, nullptr);
+    if(m_spooler.joinable()) {
+        m_spooler.join();
+    }
 
-    // Spawn the slave
+    destroy_cgroups(m_cgroup, *m_log);
+}
 
-    if(::execve(argv[0], argv.data(), envp.data()) != 0) {
-        std::error_code ec(errno, std::system_category());
-        std::cerr << cocaine::format("unable to execute '{}' - [{}] {}", path, ec.value(), ec.message());
+std::unique_ptr<api::cancellation_t>
+process_t::spool(std::shared_ptr<api::spool_handle_base_t> handler) {
+    COCAINE_LOG_INFO(m_log, "deploying app to {}", m_working_directory);
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    // The storage may complete the request after this isolate is gone, so the callback refers to
+    // nothing but the promise.
+    auto promise = std::make_shared<std::promise<std::string>>();
+    const auto future = promise->get_future().share();
+
+    api::storage(m_context, "core")->get<std::string>("apps", m_name, [=](std::future<std::string> result) {
+        try {
+            promise->set_value(result.get());
+        } catch(...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+
+    const auto previous = std::make_shared<std::thread>(std::move(m_spooler));
+    const auto lock = directory_lock(m_working_directory.native());
+
+    // Unpacking may take a while for large apps, so it's done in a dedicated thread to block
+    // neither the storage nor the I/O loop.
+    m_spooler = std::thread([=] {
+        if(previous->joinable()) {
+            previous->join();
+        }
+
+        const auto stopped = [=]() -> bool {
+            return cancelled->load() || m_stopped.load();
+        };
+
+        const auto fail = [=](std::error_code ec, std::string reason) {
+            io_context.post([=] {
+                if(!cancelled->load()) {
+                    handler->on_abort(ec, reason);
+                }
+            });
+        };
+
+        try {
+            while(future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+                if(stopped()) {
+                    return;
+                }
+            }
+
+            const auto& archive = future.get();
+
+            deploy_stats_t stats;
+            {
+                std::lock_guard<std::mutex> guard(*lock);
+                stats = archive_t(m_context, archive).deploy(
+                    m_working_directory.native(), m_spool_concurrency, m_spool_cache.native(), stopped
+                );
+            }
+
+            if(!m_spool_cache.empty()) {
+                auto& hub = m_context.metrics_hub();
+
+                hub.counter<std::int64_t>(cocaine::format("{}.spool.cache.hits", m_name))
+                    ->fetch_add(static_cast<std::int64_t>(stats.hits));
+                hub.counter<std::int64_t>(cocaine::format("{}.spool.cache.misses", m_name))
+                    ->fetch_add(static_cast<std::int64_t>(stats.misses));
+                hub.counter<std::int64_t>(cocaine::format("{}.spool.cache.bytes_saved", m_name))
+                    ->fetch_add(static_cast<std::int64_t>(stats.saved));
+
+                // Files of previous app versions are no longer linked from anywhere.
+                archive_t::collect(m_spool_cache.native());
+            }
+
+            io_context.post([=] {
+                if(!cancelled->load()) {
+                    handler->on_ready();
+                }
+            });
+        } catch(const std::system_error& err) {
+            fail(err.code(), err.what());
+        } catch(const std::exception& err) {
+            fail(error::uncaught_spool_error, err.what());
+        }
+    });
+
+    return std::unique_ptr<api::cancellation_t>(new spool_cancellation_t(std::move(cancelled)));
+}
+
+std::unique_ptr<api::cancellation_t>
+process_t::spawn(const std::string& path,
+            const api::args_t& args,
+            const api::env_t& environment,
+            std::shared_ptr<api::spawn_handle_base_t> handle)
+{
+    // Prepare the command line and the environment
+
+    auto target = fs::path(path);
+
+    if(!target.is_absolute()) {
+        target = m_working_directory / target;
     }
 
-    std::_Exit(EXIT_FAILURE);
+    command_t command(target, args, environment);
+
+    std::array<int, 2> pipes;
+
+    if(::pipe(pipes.data()) != 0) {
+        throw std::system_error(errno, std::system_category(), "unable to create an output pipe");
+    }
+
+    for(auto it = pipes.begin(); it != pipes.end(); ++it) {
+        ::fcntl(*it, F_SETFD, FD_CLOEXEC);
+    }
+
+    const pid_t pid = m_vfork ?
+        spawn_vforked(path, command, pipes, m_cgroup, m_name, *m_log, m_working_directory) :
+        spawn_forked(path, command, pipes, m_cgroup, *m_log, m_working_directory);
+
+    ::close(pipes[1]);
+
+    io_context.post([=](){
+        handle->on_ready();
+    });
+    std::unique_ptr<logging::logger_t> fetcher_logger(m_context.log("process_fetcher"));
+    std::unique_ptr<logging::logger_t> terminator_logger(m_context.log("process_terminator"));
+    auto fetcher = std::make_shared<fetcher_t>(io_context, handle, std::move(fetcher_logger));
+    fetcher->assign(pipes[0]);
+    std::unique_ptr<api::cancellation_t> terminator(new process_terminator_t(
+        pid,
+        m_kill_timeout,
+        std::move(terminator_logger),
+        io_context,
+        std::move(fetcher)
+    ));
+    return terminator;
 }
 
 void
@@ -20,9 +20,19 @@
 
 #include "cocaine/detail/isolate/archive.hpp"
 
+#include "util/sha1.hpp"
+
 #include <cocaine/context.hpp>
 #include <cocaine/logging.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/operations.hpp>
 
@@ -76,6 +86,384 @@ struct archive_error_t:
     { }
 };
 
+archive*
+disk_writer() {
+    archive* target = archive_write_disk_new();
+
+    int flags = ARCHIVE_EXTRACT_TIME |
+                ARCHIVE_EXTRACT_SECURE_SYMLINKS |
+                ARCHIVE_EXTRACT_SECURE_NODOTDOT;
+
+    archive_write_disk_set_options(target, flags);
+    archive_write_disk_set_standard_lookup(target);
+
+    return target;
+}
+
+void
+free_writer(archive* target) {
+    archive_write_close(target);
+
+#if ARCHIVE_VERSION_NUMBER < 3000000
+    archive_write_finish(target);
+#else
+    archive_write_free(target);
+#endif
+}
+
+// Reads the whole data of the current entry, filling holes of sparse files with zeroes. Only used
+// for entries not larger than the streaming threshold.
+std::string
+read_data(archive* source, archive_entry* entry) {
+    std::string data(static_cast<std::size_t>(archive_entry_size(entry)), '\0');
+    std::size_t offset = 0;
+
+    while(offset < data.size()) {
+        const auto rv = archive_read_data(source, &data[offset], data.size() - offset);
+
+        if(rv < 0) {
+            throw archive_error_t(source);
+        } else if(rv == 0) {
+            break;
+        }
+
+        offset += static_cast<std::size_t>(rv);
+    }
+
+    data.resize(offset);
+    return data;
+}
+
+void
+write_entry(archive* target, archive_entry* entry, const std::string& data) {
+    if(archive_write_header(target, entry) != ARCHIVE_OK) {
+        throw archive_error_t(target);
+    }
+
+    std::size_t offset = 0;
+
+    while(offset < data.size()) {
+        const auto rv = archive_write_data(target, data.data() + offset, data.size() - offset);
+
+        if(rv < 0) {
+            throw archive_error_t(target);
+        } else if(rv == 0) {
+            break;
+        }
+
+        offset += static_cast<std::size_t>(rv);
+    }
+
+    if(archive_write_finish_entry(target) != ARCHIVE_OK) {
+        throw archive_error_t(target);
+    }
+}
+
+struct pending_file_t {
+    std::shared_ptr<archive_entry> entry;
+    std::string data;
+};
+
+// Writes regular files either directly or through the content-addressed cache. Cache hits are
+// hardlinks, so the metadata of the entry is not applied to them.
+//
+// Linking bypasses the disk writer along with its checks against path traversal, so files which
+// might end up outside of the prefix are always written by the disk writer.
+class file_store_t {
+    const fs::path prefix;
+    const fs::path cache;
+
+    std::atomic<std::size_t> hits;
+    std::atomic<std::size_t> misses;
+    std::atomic<std::uint64_t> saved;
+
+public:
+    explicit
+    file_store_t(fs::path prefix, fs::path cache):
+        prefix(std::move(prefix)),
+        cache(std::move(cache)),
+        hits(0),
+        misses(0),
+        saved(0)
+    {}
+
+    bool
+    enabled() const {
+        return !cache.empty();
+    }
+
+    void
+    store(archive* target, const pending_file_t& file) {
+        if(!enabled()) {
+            write_entry(target, file.entry.get(), file.data);
+            misses++;
+            return;
+        }
+
+        const fs::path path = archive_entry_pathname(file.entry.get());
+
+        if(!contained(path)) {
+            write_entry(target, file.entry.get(), file.data);
+            misses++;
+            return;
+        }
+
+        const fs::path object = cache / name(file);
+
+        boost::system::error_code ec;
+
+        if(fs::exists(object, ec) && fs::file_size(object, ec) == file.data.size()) {
+            // The link is made aside and renamed over the target, so a failure leaves it intact.
+            const auto temporary = path.parent_path() / (path.filename().string() + ".cocaine-link");
+
+            fs::create_directories(path.parent_path(), ec);
+            fs::remove(temporary, ec);
+            fs::create_hard_link(object, temporary, ec);
+
+            if(!ec) {
+                fs::rename(temporary, path, ec);
+            }
+
+            if(!ec) {
+                hits++;
+                saved += file.data.size();
+                return;
+            }
+
+            fs::remove(temporary, ec);
+        }
+
+        write_entry(target, file.entry.get(), file.data);
+        misses++;
+
+        // Failing to populate the cache, for example due to a concurrent deploy of the same file,
+        // is not an error.
+        fs::create_directories(object.parent_path(), ec);
+        fs::create_hard_link(path, object, ec);
+    }
+
+    deploy_stats_t
+    stats() const {
+        return deploy_stats_t{hits.load(), misses.load(), saved.load()};
+    }
+
+private:
+    // Tells whether the path lies within the prefix: it has no `..` components and none of its
+    // existing parents within the prefix is a symlink or not a directory.
+    bool
+    contained(const fs::path& path) const {
+        const auto components = [](const fs::path& path) {
+            std::vector<fs::path> result;
+
+            for(const auto& component : path) {
+                if(!component.empty() && component != ".") {
+                    result.push_back(component);
+                }
+            }
+
+            return result;
+        };
+
+        const auto base = components(prefix);
+        const auto full = components(path);
+
+        if(full.size() <= base.size() || !std::equal(base.begin(), base.end(), full.begin())) {
+            return false;
+        }
+
+        fs::path current = prefix;
+
+        for(auto it = full.begin() + static_cast<std::ptrdiff_t>(base.size()); it != full.end(); ++it) {
+            if(*it == "..") {
+                return false;
+            }
+
+            if(it + 1 == full.end()) {
+                break;
+            }
+
+            current /= *it;
+
+            boost::system::error_code ec;
+            const auto status = fs::symlink_status(current, ec);
+
+            if(fs::exists(status) && (fs::is_symlink(status) || !fs::is_directory(status))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Returns the object path relative to the cache directory, which is the SHA-1 of the file mode
+    // and data splitted into a two-character fan-out directory and the rest.
+    static
+    fs::path
+    name(const pending_file_t& file) {
+        util::sha1_t sha;
+
+        const auto mode = static_cast<std::uint32_t>(archive_entry_mode(file.entry.get()));
+        sha.update(&mode, sizeof(mode));
+        sha.update(file.data.data(), file.data.size());
+
+        const auto hex = sha.hexdigest();
+
+        return fs::path(hex.substr(0, 2)) / hex.substr(2);
+    }
+};
+
+// Writes regular files to disk using a fixed number of threads, each having its own disk writer.
+//
+// The amount of buffered file data is bounded to keep memory usage under control, so the reader
+// blocks when writers can't keep up. Files must not be larger than the limit.
+class writer_pool_t {
+    file_store_t& store;
+
+    const std::size_t limit;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable vacant;
+
+    std::deque<pending_file_t> tasks;
+    std::size_t buffered;
+    bool closed;
+
+    // The first error occurred, further files are skipped then.
+    std::exception_ptr error;
+
+    std::vector<std::thread> threads;
+
+public:
+    writer_pool_t(file_store_t& store, std::size_t concurrency, std::size_t limit):
+        store(store),
+        limit(limit),
+        buffered(0),
+        closed(false)
+    {
+        for(std::size_t id = 0; id < concurrency; ++id) {
+            threads.emplace_back(&writer_pool_t::run, this);
+        }
+    }
+
+   ~writer_pool_t() {
+        close();
+    }
+
+    void
+    push(pending_file_t task) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        vacant.wait(lock, [&] {
+            return error || buffered + task.data.size() <= limit;
+        });
+
+        if(error) {
+            std::rethrow_exception(error);
+        }
+
+        buffered += task.data.size();
+        tasks.push_back(std::move(task));
+        ready.notify_one();
+    }
+
+    // Waits for all pushed files to be written, rethrowing the first error if any.
+    void
+    drain() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // Every pushed file has some data, so nothing is in flight once the buffer is empty.
+        vacant.wait(lock, [&] {
+            return error || buffered == 0;
+        });
+
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Waits for all pending files to be written, rethrowing the first error if any.
+    void
+    join() {
+        close();
+
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void
+    close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+
+        ready.notify_all();
+
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        threads.clear();
+    }
+
+    void
+    run() {
+        archive* target = disk_writer();
+
+        while(true) {
+            pending_file_t task;
+            bool failed = false;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&] { return closed || !tasks.empty(); });
+
+                if(tasks.empty()) {
+                    break;
+                }
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                failed = static_cast<bool>(error);
+            }
+
+            std::exception_ptr ep;
+
+            if(!failed) {
+                try {
+                    store.store(target, task);
+                } catch(...) {
+                    ep = std::current_exception();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                buffered -= task.data.size();
+
+                if(ep && !error) {
+                    error = ep;
+                }
+            }
+
+            vacant.notify_all();
+        }
+
+        free_writer(target);
+    }
+};
+
+// Maximum amount of file data buffered for parallel writers.
+const std::size_t buffer_limit = 64 * 1024 * 1024;
+
+// Files larger than this are streamed to disk by the reader instead of being buffered.
+const std::size_t stream_threshold = 1024 * 1024;
+
+static_assert(stream_threshold <= buffer_limit, "buffered files must fit into the buffer limit");
+
 } // namespace
 
 archive_t::archive_t(context_t& context, const std::string& archive):
@@ -113,8 +501,12 @@ archive_t::~archive_t() {
 #endif
 }
 
-void
-archive_t::deploy(const std::string& prefix_) {
+deploy_stats_t
+archive_t::deploy(const std::string& prefix_,
+                  std::size_t concurrency,
+                  const std::string& cache,
+                  std::function<bool()> cancelled)
+{
     const fs::path prefix = prefix_;
 
     if(fs::exists(prefix)) {
@@ -125,19 +517,27 @@ archive_t::deploy(const std::string& prefix_) {
         }
     }
 
-    archive* target = archive_write_disk_new();
+    archive* target = disk_writer();
     archive_entry* entry = nullptr;
 
     int rv = ARCHIVE_OK;
 
-    int flags = ARCHIVE_EXTRACT_TIME |
-                ARCHIVE_EXTRACT_SECURE_SYMLINKS |
-                ARCHIVE_EXTRACT_SECURE_NODOTDOT;
+    // Small regular files are offloaded to parallel writers, while large files, directories, links
+    // and other special entries are written here. Hardlinks wait for pending files to be written,
+    // because their targets may be among them.
+    file_store_t store(prefix, cache);
 
-    archive_write_disk_set_options(target, flags);
-    archive_write_disk_set_standard_lookup(target);
+    std::unique_ptr<writer_pool_t> pool;
+
+    if(concurrency > 1) {
+        pool.reset(new writer_pool_t(store, concurrency, buffer_limit));
+    }
 
     while(true) {
+        if(cancelled && cancelled()) {
+            throw std::system_error(std::make_error_code(std::errc::operation_canceled));
+        }
+
         rv = archive_read_next_header(m_archive, &entry);
 
         if(rv == ARCHIVE_EOF) {
@@ -162,6 +562,29 @@ archive_t::deploy(const std::string& prefix_) {
 
         COCAINE_LOG_DEBUG(m_log, "extracting {}", pathname);
 
+        const auto clone = [&] {
+            return std::shared_ptr<archive_entry>(archive_entry_clone(entry), &archive_entry_free);
+        };
+
+        if(pool && archive_entry_hardlink(entry)) {
+            pool->drain();
+        }
+
+        const bool regular = !archive_entry_hardlink(entry) &&
+            archive_entry_filetype(entry) == AE_IFREG &&
+            archive_entry_size(entry) > 0 &&
+            static_cast<std::size_t>(archive_entry_size(entry)) <= stream_threshold;
+
+        if(regular && pool) {
+            pool->push(pending_file_t{clone(), read_data(m_archive, entry)});
+            continue;
+        }
+
+        if(regular && store.enabled()) {
+            store.store(target, pending_file_t{clone(), read_data(m_archive, entry)});
+            continue;
+        }
+
         rv = archive_write_header(target, entry);
 
         if(rv != ARCHIVE_OK) {
@@ -177,17 +600,49 @@ archive_t::deploy(const std::string& prefix_) {
         }
     }
 
-    archive_write_close(target);
+    if(pool) {
+        pool->join();
+    }
 
-#if ARCHIVE_VERSION_NUMBER < 3000000
-    archive_write_finish(target);
-#else
-    archive_write_free(target);
-#endif
+    // Closing the writer also applies deferred directory attributes, so it must happen after all
+    // files have been written.
+    free_writer(target);
 
     const auto count = archive_file_count(m_archive);
+    const auto stats = store.stats();
+
+    if(store.enabled()) {
+        COCAINE_LOG_INFO(m_log, "extracted {} file(s), {} linked from cache saving {} bytes",
+                         count, stats.hits, stats.saved);
+    } else {
+        COCAINE_LOG_INFO(m_log, "extracted {} file(s)", count);
+    }
+
+    return stats;
+}
+
+std::size_t
+archive_t::collect(const std::string& cache) {
+    std::size_t removed = 0;
+
+    boost::system::error_code ec;
+
+    if(!fs::is_directory(cache, ec)) {
+        return removed;
+    }
+
+    for(fs::recursive_directory_iterator it(cache, ec), end; !ec && it != end; it.increment(ec)) {
+        if(!fs::is_regular_file(it->path(), ec)) {
+            continue;
+        }
+
+        // The only remaining link is the cache entry itself.
+        if(fs::hard_link_count(it->path(), ec) == 1 && fs::remove(it->path(), ec)) {
+            ++removed;
+        }
+    }
 
-    COCAINE_LOG_INFO(m_log, "extracted {} file(s)", count);
+    return removed;
 }
 
 void
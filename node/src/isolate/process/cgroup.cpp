@@ -1,5 +1,10 @@
 #include <iostream>
 
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <libcgroup.h>
 
 #include <boost/lexical_cast.hpp>
@@ -136,6 +141,50 @@ void attach_cgroups(void* cgroup_raw_ptr, logging::logger_t& log) {
     }
 }
 
+std::vector<int> open_cgroups(void* cgroup_raw_ptr, const char* cgroup_name, logging::logger_t& log) {
+    cgroup* cgroup_ptr = reinterpret_cast<cgroup*>(cgroup_raw_ptr);
+
+    std::vector<int> fds;
+
+    auto close_all = [&] {
+        for(int fd : fds) {
+            ::close(fd);
+        }
+    };
+
+    const int count = cgroup_get_controller_count(cgroup_ptr);
+
+    for(int id = 0; id < count; ++id) {
+        const char* controller = cgroup_get_controller_name(cgroup_get_controller(cgroup_ptr, id));
+
+        char* mount_point = nullptr;
+        int rv = 0;
+
+        if((rv = cgroup_get_subsys_mount_point(controller, &mount_point)) != 0) {
+            close_all();
+            throw std::system_error(rv, error::cgroup_category(), cocaine::format(
+                "unable to locate the mount point of cgroup controller '{}'", controller
+            ));
+        }
+
+        const auto path = cocaine::format("{}/{}/tasks", mount_point, cgroup_name);
+        std::free(mount_point);
+
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+
+        if(fd < 0) {
+            const int ec = errno;
+            COCAINE_LOG_ERROR(log, "unable to open cgroup tasks file '{}': {}", path, ec);
+            close_all();
+            throw std::system_error(ec, std::system_category(), "unable to open cgroup tasks file");
+        }
+
+        fds.push_back(fd);
+    }
+
+    return fds;
+}
+
 const char* get_cgroup_error(int code) {
     return cgroup_strerror(code);
 }
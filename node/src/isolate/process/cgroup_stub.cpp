@@ -30,6 +30,10 @@ void attach_cgroups(void*, logging::logger_t&) {
     // Pass.
 }
 
+std::vector<int> open_cgroups(void*, const char*, logging::logger_t&) {
+    return {};
+}
+
 const char* get_cgroup_error(int) {
     return "can not get error message, cgroup support was disabled during compilation";
 }
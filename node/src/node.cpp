@@ -49,6 +49,9 @@
 
 #include "cocaine/service/node/overseer.hpp"
 
+#include "node/isometrics.hpp"
+#include "node/resolver.hpp"
+
 using namespace cocaine;
 using namespace cocaine::service;
 
@@ -245,7 +248,9 @@ node_t::node_t(context_t& context, asio::io_service& asio, const std::string& na
     category_type(context, asio, name, args),
     dispatch<io::node_tag>(name),
     log(context.log(name)),
-    context(context)
+    context(context),
+    metrics_poller(node::metrics_poller_t::make(context, asio, args)),
+    resolver(node::resolver_t::make(context, args))
 {
     auto audit = std::shared_ptr<logging::logger_t>(context.log("audit", {{"service", name}}));
     auto middleware = middleware::auth_t(context, name);
@@ -369,30 +374,61 @@ node_t::node_t(context_t& context, asio::io_service& asio, const std::string& na
 
     COCAINE_LOG_INFO(log, "starting {} app(s)", runlist.size());
 
-    std::vector<std::string> errored;
+    // Apps resolve their manifests and profiles asynchronously, so failures are collected from
+    // the start callbacks and summarized once the last app of the runlist reports back.
+    struct report_t {
+        std::size_t pending;
+        std::vector<std::string> errored;
+    };
+
+    auto report = std::make_shared<synchronized<report_t>>(report_t{runlist.size(), {}});
+    auto logger = log;
+
+    auto complete = [=](const std::string& app, const std::exception* err) {
+        if(err) {
+            const blackhole::scope::holder_t scoped(*logger, {{ "app", app }});
+            COCAINE_LOG_WARNING(logger, "unable to initialize app: {}", err->what());
+        }
+
+        report->apply([&](report_t& state) {
+            if(err) {
+                state.errored.push_back(app);
+            }
+
+            if(--state.pending == 0 && !state.errored.empty()) {
+                COCAINE_LOG_WARNING(logger, "couldn't start {} app(s): {}", state.errored.size(),
+                    boost::join(state.errored, ", "));
+            }
+        });
+    };
 
     std::string app;
     std::string profile;
     for (const auto& run : runlist) {
         std::tie(app, profile) = run;
-        const blackhole::scope::holder_t scoped(*log, {{ "app", app }});
 
         try {
-            start_app(app, profile);
+            start_app(app, profile, [=](std::future<void> future) {
+                try {
+                    future.get();
+                    complete(app, nullptr);
+                } catch(const std::exception& err) {
+                    complete(app, &err);
+                }
+            });
         } catch(const std::exception& err) {
-            COCAINE_LOG_WARNING(log, "unable to initialize app: {}", err.what());
-            errored.push_back(app);
+            complete(app, &err);
         }
     }
 
-    if(!errored.empty()) {
-        COCAINE_LOG_WARNING(log, "couldn't start {} app(s): {}", errored.size(), boost::join(errored, ", "));
-    }
-
     context.signal_hub().listen(signal, asio);
 }
 
-node_t::~node_t() = default;
+node_t::~node_t() {
+    if (metrics_poller) {
+        metrics_poller->cancel();
+    }
+}
 
 auto
 node_t::prototype() -> io::basic_dispatch_t&{
@@ -441,7 +477,7 @@ node_t::start_app(const std::string& name, const std::string& profile, callback_
 
         apps.insert({
             name,
-            std::make_shared<node::app_t>(context, name, profile, std::move(callback))
+            std::make_shared<node::app_t>(context, name, profile, std::move(callback), metrics_poller, resolver)
         });
     });
 }
@@ -28,6 +28,7 @@
 
 #include "actor.hpp"
 #include "pool_observer.hpp"
+#include "resolver.hpp"
 
 namespace ph = std::placeholders;
 
@@ -285,6 +286,20 @@ public:
     }
 };
 
+/// The application is fetching its manifest and profile.
+class resolving_t:
+    public base_t
+{
+public:
+    virtual
+    dynamic_t::object_t
+    info(io::node::info::flags_t) const {
+        dynamic_t::object_t info;
+        info["state"] = "resolving";
+        return info;
+    }
+};
+
 /// The application is currently spooling.
 class spooling_t:
     public base_t
@@ -356,14 +371,16 @@ public:
               const manifest_t& manifest,
               const profile_t& profile,
               logging::logger_t* const log,
-              std::shared_ptr<asio::io_service> loop):
+              std::shared_ptr<asio::io_service> loop,
+              std::shared_ptr<metrics_poller_t> metrics_poller):
         log(log),
         context(context_),
         name(manifest.name)
     {
         // Create an Overseer - slave spawner/despawner plus the event queue dispatcher.
         overseer_ = std::make_shared<overseer_proxy_t>(
-            std::make_shared<overseer_t>(context, manifest, profile, std::make_shared<observer_adapter_t>(*this), loop)
+            std::make_shared<overseer_t>(context, manifest, profile, std::make_shared<observer_adapter_t>(*this), loop,
+                std::move(metrics_poller))
         );
 
         // Create an unix actor and bind to {manifest->name}.{pid} unix-socket.
@@ -504,48 +521,52 @@ class cocaine::service::node::app_state_t
     /// Node start request's callback.
     std::function<void(std::future<void> future)> callback;
 
-    // Configuration.
-    const manifest_t manifest_;
-    const profile_t  profile;
+    const std::string name_;
+    const std::string profile_name;
+
+    // Configuration, resolved asynchronously and accessed from the I/O thread only.
+    std::unique_ptr<const manifest_t> manifest_;
+    std::unique_ptr<const profile_t> profile;
 
     std::shared_ptr<asio::io_service> loop;
 
+    // Node-wide isolate metrics poller, null if disabled.
+    std::shared_ptr<metrics_poller_t> metrics_poller;
+
+    // Node-wide manifest and profile resolver.
+    std::shared_ptr<resolver_t> resolver;
+
     // Bind isolation to application lifetime to ensure,
     // that isolation object is not being recreated all the times.
     api::category_traits<api::isolate_t>::ptr_type isolate;
 
 public:
     app_state_t(context_t& context,
-                manifest_t manifest_,
-                profile_t profile_,
+                std::string name_,
+                std::string profile_name,
                 std::function<void(std::future<void>)> callback,
-                std::shared_ptr<asio::io_service> loop_):
-        log(context.log(format("{}/app", manifest_.name))),
+                std::shared_ptr<asio::io_service> loop_,
+                std::shared_ptr<metrics_poller_t> metrics_poller_,
+                std::shared_ptr<resolver_t> resolver_):
+        log(context.log(format("{}/app", name_))),
         context(context),
         state(new state::stopped_t),
         callback(std::move(callback)),
-        manifest_(std::move(manifest_)),
-        profile(std::move(profile_)),
+        name_(std::move(name_)),
+        profile_name(std::move(profile_name)),
         loop(std::move(loop_)),
+        metrics_poller(std::move(metrics_poller_)),
+        resolver(std::move(resolver_)),
         isolate()
-    {
-        isolate = context.repository().get<api::isolate_t>(
-            profile.isolate.type,
-            context,
-            *loop,
-            manifest().name,
-            profile.isolate.type,
-            profile.isolate.args
-        );
-    }
+    {}
 
     auto logger() noexcept -> logging::logger_t& {
         return *log;
     }
 
-    const manifest_t&
-    manifest() const noexcept {
-        return manifest_;
+    const std::string&
+    name() const noexcept {
+        return name_;
     }
 
     dynamic_t
@@ -558,30 +579,133 @@ public:
         return (*state.synchronize())->overseer();
     }
 
-    auto spool() -> void {
+    /// Fetches the manifest and the profile in parallel, the app starts spooling when both of them
+    /// are ready.
+    auto resolve() -> void {
         state.apply([&](state_type& state) {
             if (!state->stopped()) {
                 throw std::logic_error("invalid state");
             }
 
+            COCAINE_LOG_DEBUG(log, "app is resolving its manifest and '{}' profile", profile_name);
+            state.reset(new state::resolving_t);
+        });
+
+        auto resolution = std::make_shared<resolution_t>(shared_from_this());
+        resolver->manifest(name_, std::bind(&resolution_t::on_manifest, resolution, ph::_1));
+        resolver->profile(profile_name, std::bind(&resolution_t::on_profile, resolution, ph::_1));
+    }
+
+    void
+    cancel(std::error_code ec) {
+        state.synchronize()->reset(new state::stopped_t(std::move(ec)));
+    }
+
+private:
+    /// Joins the manifest and the profile, which are fetched in parallel.
+    struct resolution_t :
+        public std::enable_shared_from_this<resolution_t>
+    {
+        typedef std::pair<std::future<manifest_t>, std::future<profile_t>> futures_type;
+
+        synchronized<futures_type> futures;
+
+        // The app can be stopped while resolving, there is nothing to do with the result then.
+        std::weak_ptr<app_state_t> parent;
+
+        resolution_t(const std::shared_ptr<app_state_t>& _parent) :
+            parent(_parent)
+        {}
+
+        auto on_manifest(std::future<manifest_t> future) -> void {
+            const auto ready = futures.apply([&](futures_type& futures) {
+                futures.first = std::move(future);
+                return futures.second.valid();
+            });
+
+            if (ready) {
+                complete();
+            }
+        }
+
+        auto on_profile(std::future<profile_t> future) -> void {
+            const auto ready = futures.apply([&](futures_type& futures) {
+                futures.second = std::move(future);
+                return futures.first.valid();
+            });
+
+            if (ready) {
+                complete();
+            }
+        }
+
+        auto complete() -> void {
+            if (const auto p = parent.lock()) {
+                // Storage callbacks are invoked from storage threads, move to the I/O thread.
+                p->loop->dispatch(std::bind(&app_state_t::on_resolved, p, shared_from_this()));
+            }
+        }
+    };
+
+    void
+    on_resolved(std::shared_ptr<resolution_t> resolution) {
+        if ((*state.synchronize())->stopped()) {
+            COCAINE_LOG_DEBUG(log, "app has been stopped while resolving");
+            return;
+        }
+
+        std::error_code ec;
+
+        try {
+            auto futures = resolution->futures.synchronize();
+            manifest_.reset(new manifest_t(futures->first.get()));
+            profile.reset(new profile_t(futures->second.get()));
+
+            isolate = context.repository().get<api::isolate_t>(
+                profile->isolate.type,
+                context,
+                *loop,
+                manifest_->name,
+                profile->isolate.type,
+                profile->isolate.args
+            );
+        } catch (const std::system_error& err) {
+            COCAINE_LOG_ERROR(log, "unable to resolve app: {}", error::to_string(err));
+            ec = err.code();
+            callback(make_exceptional_future<void>(err));
+        } catch (const std::exception& err) {
+            COCAINE_LOG_ERROR(log, "unable to resolve app: {}", err.what());
+            ec = error::uncaught_spool_error;
+            callback(make_exceptional_future<void>(error_t(error::uncaught_spool_error, err.what())));
+        }
+
+        if (ec) {
+            cancel(ec);
+            return;
+        }
+
+        spool();
+    }
+
+    auto spool() -> void {
+        state.apply([&](state_type& state) {
+            if (state->stopped()) {
+                COCAINE_LOG_DEBUG(log, "app has been stopped while resolving");
+                return;
+            }
+
             COCAINE_LOG_DEBUG(log, "app is spooling");
             state.reset(new state::spooling_t(
                 context,
                 *loop,
-                manifest(),
-                profile,
+                *manifest_,
+                *profile,
                 log.get(),
                 std::make_shared<spool_handle_t>(shared_from_this())
             ));
         });
     }
 
-    void
-    cancel(std::error_code ec) {
-        state.synchronize()->reset(new state::stopped_t(std::move(ec)));
-    }
-
-private:
     struct spool_handle_t :
         public api::spool_handle_base_t,
         public std::enable_shared_from_this<spool_handle_t>
@@ -629,7 +753,7 @@ private:
 
         try {
             state.synchronize()->reset(
-                new state::running_t(context, manifest(), profile, log.get(), loop)
+                new state::running_t(context, *manifest_, *profile, log.get(), loop, metrics_poller)
             );
             callback(make_ready_future());
         } catch (const std::system_error& err) {
@@ -651,21 +775,25 @@ private:
 app_t::app_t(context_t& context,
              const std::string& name,
              const std::string& profile,
-             std::function<void(std::future<void> future)> callback):
+             std::function<void(std::future<void> future)> callback,
+             std::shared_ptr<metrics_poller_t> metrics_poller,
+             std::shared_ptr<resolver_t> resolver):
     loop(std::make_shared<asio::io_service>()),
     work(std::make_unique<asio::io_service::work>(*loop)),
     thread(nullptr)
 {
     state = std::make_shared<app_state_t>(
         context,
-        manifest_t(context, name),
-        profile_t(context, profile),
+        name,
+        profile,
         std::move(callback),
-        loop
+        loop,
+        std::move(metrics_poller),
+        std::move(resolver)
     );
     COCAINE_LOG_DEBUG(state->logger(), "application has initialized its internal state");
 
-    state->spool();
+    state->resolve();
 
     thread = std::make_unique<boost::thread>([&] {
         loop->run();
@@ -685,7 +813,7 @@ app_t::~app_t() {
 
 std::string
 app_t::name() const {
-    return state->manifest().name;
+    return state->name();
 }
 
 dynamic_t
@@ -0,0 +1,248 @@
+#include "crashlog.hpp"
+
+#include <algorithm>
+#include <ctime>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <blackhole/logger.hpp>
+
+#include <cocaine/api/storage.hpp>
+#include <cocaine/context.hpp>
+#include <cocaine/format.hpp>
+#include <cocaine/logging.hpp>
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+namespace ph = std::placeholders;
+
+namespace {
+
+/// Maximum number of recently accepted crashlogs to look for duplicates among.
+constexpr std::size_t dedup_capacity = 64;
+
+auto
+digest(const std::vector<std::string>& lines) -> std::size_t {
+    std::size_t seed = 0;
+    for (const auto& line : lines) {
+        boost::hash_combine(seed, line);
+    }
+
+    return seed;
+}
+
+auto
+make_indexes(const std::string& app) -> std::vector<std::string> {
+    std::vector<std::string> indexes{app};
+
+    std::time_t time = std::time(nullptr);
+    char buf[64];
+    if (auto len = std::strftime(buf, sizeof(buf), "cocaine-%Y-%m-%d", std::gmtime(&time))) {
+        indexes.emplace_back(buf, len);
+    }
+
+    return indexes;
+}
+
+}  // namespace
+
+crashlog_writer_t::crashlog_writer_t(context_t& context,
+                                     const std::string& app,
+                                     const profile_t& profile,
+                                     stats_t::crashlogs_t stats,
+                                     asio::io_service& loop) :
+    context(context),
+    log(context.log(format("{}/crashlog", app))),
+    app(app),
+    options(profile.crashlog_upload),
+    stats(std::move(stats)),
+    timer(loop)
+{
+    state.apply([&](state_t& state) {
+        state.tokens = options.burst;
+        state.refilled = clock_type::now();
+        state.inflight = 0;
+        state.scheduled = false;
+        state.cancelled = false;
+    });
+}
+
+auto
+crashlog_writer_t::push(const std::string& id, std::vector<std::string> lines) -> void {
+    const auto hash = digest(lines);
+
+    const auto us = std::chrono::duration_cast<
+        std::chrono::microseconds
+    >(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    crashlog_t crashlog{format("{}:{}", us, id), std::move(lines), make_indexes(app)};
+
+    const auto now = clock_type::now();
+    const auto window = std::chrono::duration_cast<clock_type::duration>(
+        std::chrono::duration<double>(options.dedup_window));
+
+    const auto duplicate = [&](const std::pair<std::size_t, clock_type::time_point>& recent) {
+        return recent.first == hash;
+    };
+
+    auto batch = state.apply([&](state_t& state) -> std::vector<crashlog_t> {
+        if (state.cancelled) {
+            stats.dropped->fetch_add(1);
+            return {};
+        }
+
+        while (!state.recent.empty() && now - state.recent.front().second >= window) {
+            state.recent.pop_front();
+        }
+
+        if (std::any_of(state.recent.begin(), state.recent.end(), duplicate)) {
+            COCAINE_LOG_INFO(log, "crashlog '{}' is dropped as a duplicate of a recent one", crashlog.key);
+            stats.deduplicated->fetch_add(1);
+            return {};
+        }
+
+        if (state.queue.size() >= options.queue_limit) {
+            COCAINE_LOG_WARNING(log, "crashlog '{}' is dropped: upload queue is full", crashlog.key);
+            stats.dropped->fetch_add(1);
+            return {};
+        }
+
+        state.recent.emplace_back(hash, now);
+        if (state.recent.size() > dedup_capacity) {
+            state.recent.pop_front();
+        }
+
+        state.queue.push_back(std::move(crashlog));
+
+        return take(state);
+    });
+
+    write(std::move(batch));
+}
+
+auto
+crashlog_writer_t::cancel() -> void {
+    state.apply([&](state_t& state) {
+        state.cancelled = true;
+
+        if (!state.queue.empty()) {
+            COCAINE_LOG_WARNING(log, "dropping {} pending crashlog(s)", state.queue.size());
+            stats.dropped->fetch_add(static_cast<std::int64_t>(state.queue.size()));
+            state.queue.clear();
+        }
+
+        timer.cancel();
+    });
+}
+
+auto
+crashlog_writer_t::take(state_t& state) -> std::vector<crashlog_t> {
+    std::vector<crashlog_t> batch;
+
+    const auto limited = options.rate > 0;
+
+    if (limited) {
+        const auto now = clock_type::now();
+        const auto elapsed = std::chrono::duration<double>(now - state.refilled).count();
+
+        state.tokens = std::min(static_cast<double>(options.burst), state.tokens + elapsed * options.rate);
+        state.refilled = now;
+    }
+
+    while (!state.queue.empty() && state.inflight < options.concurrency) {
+        if (limited) {
+            if (state.tokens < 1.0) {
+                break;
+            }
+
+            state.tokens -= 1.0;
+        }
+
+        batch.push_back(std::move(state.queue.front()));
+        state.queue.pop_front();
+        ++state.inflight;
+    }
+
+    // Otherwise either the queue is drained or the rest is taken on write completion.
+    if (!state.queue.empty() && state.inflight < options.concurrency && !state.scheduled) {
+        const auto delay = (1.0 - state.tokens) / options.rate;
+
+        state.scheduled = true;
+        timer.expires_from_now(boost::posix_time::microseconds(static_cast<std::int64_t>(delay * 1e6) + 1));
+        timer.async_wait(std::bind(&crashlog_writer_t::on_timer, shared_from_this(), ph::_1));
+    }
+
+    return batch;
+}
+
+auto
+crashlog_writer_t::write(std::vector<crashlog_t> batch) -> void {
+    auto self = shared_from_this();
+
+    for (const auto& crashlog : batch) {
+        COCAINE_LOG_INFO(log, "slave is dumping output to 'crashlogs/{}' using [{}] indexes",
+                         crashlog.key, boost::join(crashlog.indexes, ", "));
+
+        const auto key = crashlog.key;
+
+        try {
+            api::storage(context, "core")->put("crashlogs", crashlog.key, crashlog.lines, crashlog.indexes,
+                [=](std::future<void> future) {
+                    try {
+                        future.get();
+                        self->stats.written->fetch_add(1);
+                    } catch (const std::exception& err) {
+                        COCAINE_LOG_WARNING(self->log, "unable to save the crashlog '{}': {}", key, err.what());
+                        self->stats.failed->fetch_add(1);
+                    }
+
+                    self->on_written();
+                }
+            );
+        } catch (const std::exception& err) {
+            COCAINE_LOG_WARNING(log, "unable to save the crashlog '{}': {}", key, err.what());
+            stats.failed->fetch_add(1);
+            on_written();
+        }
+    }
+}
+
+auto
+crashlog_writer_t::on_timer(const std::error_code& ec) -> void {
+    auto batch = state.apply([&](state_t& state) -> std::vector<crashlog_t> {
+        state.scheduled = false;
+
+        if (ec || state.cancelled) {
+            return {};
+        }
+
+        return take(state);
+    });
+
+    write(std::move(batch));
+}
+
+auto
+crashlog_writer_t::on_written() -> void {
+    auto batch = state.apply([&](state_t& state) -> std::vector<crashlog_t> {
+        --state.inflight;
+
+        if (state.cancelled) {
+            return {};
+        }
+
+        return take(state);
+    });
+
+    write(std::move(batch));
+}
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <asio/deadline_timer.hpp>
+#include <asio/io_service.hpp>
+
+#include <cocaine/forwards.hpp>
+#include <cocaine/locked_ptr.hpp>
+
+#include "cocaine/service/node/profile.hpp"
+#include "cocaine/detail/service/node/stats.hpp"
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+/// Uploads crashlogs of dead slaves of a single application into the core storage.
+///
+/// Crashlogs are queued up to the profile limit and released in batches no faster than a token
+/// bucket allows, with a bounded number of concurrent storage writes. A crashlog identical to one
+/// accepted within the configured window is dropped, because during a crash storm slaves usually
+/// die the same way, while a crash repeating later is still recorded.
+///
+/// All methods are thread-safe.
+class crashlog_writer_t : public std::enable_shared_from_this<crashlog_writer_t> {
+    typedef std::chrono::steady_clock clock_type;
+
+    struct crashlog_t {
+        std::string key;
+        std::vector<std::string> lines;
+        std::vector<std::string> indexes;
+    };
+
+    struct state_t {
+        std::deque<crashlog_t> queue;
+
+        /// Content digests of recently accepted crashlogs with their acceptance time, the newest
+        /// one is at the back.
+        std::deque<std::pair<std::size_t, clock_type::time_point>> recent;
+
+        /// Token bucket.
+        double tokens;
+        clock_type::time_point refilled;
+
+        /// Number of storage writes in flight.
+        std::size_t inflight;
+
+        /// Whether the timer is waiting for tokens.
+        bool scheduled;
+        bool cancelled;
+    };
+
+    context_t& context;
+
+    const std::unique_ptr<logging::logger_t> log;
+
+    const std::string app;
+    const decltype(profile_t::crashlog_upload) options;
+
+    stats_t::crashlogs_t stats;
+
+    synchronized<state_t> state;
+
+    /// Guarded by the state lock.
+    asio::deadline_timer timer;
+
+public:
+    crashlog_writer_t(context_t& context,
+                      const std::string& app,
+                      const profile_t& profile,
+                      stats_t::crashlogs_t stats,
+                      asio::io_service& loop);
+
+    /// Enqueues the output of the given dead slave to be uploaded.
+    auto
+    push(const std::string& id, std::vector<std::string> lines) -> void;
+
+    /// Drops all pending crashlogs, writes in flight are completed anyway.
+    auto
+    cancel() -> void;
+
+private:
+    /// Pops crashlogs allowed to be uploaded right now, scheduling the timer for the rest if
+    /// required.
+    auto
+    take(state_t& state) -> std::vector<crashlog_t>;
+
+    auto
+    write(std::vector<crashlog_t> batch) -> void;
+
+    auto
+    on_timer(const std::error_code& ec) -> void;
+
+    auto
+    on_written() -> void;
+};
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
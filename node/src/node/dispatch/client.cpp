@@ -8,8 +8,9 @@ client_rpc_dispatch_t::client_rpc_dispatch_t(const std::string& name):
 {
     // Uncaught exceptions here will lead to a client disconnection and further dispatch discarding.
 
-    on<protocol::chunk>([&](const std::string& chunk) {
-        write({}, chunk);
+    // The chunk is taken by value to be moved from the decoded message rather than copied.
+    on<protocol::chunk>([&](std::string chunk) {
+        write({}, std::move(chunk));
     });
 
     on<protocol::error>([&](const std::error_code& ec, const std::string& reason) {
@@ -61,6 +62,10 @@ auto client_rpc_dispatch_t::write(hpack::headers_t headers, const std::string& d
     stream().write(std::move(headers), data);
 }
 
+auto client_rpc_dispatch_t::write(hpack::headers_t headers, std::string&& data) -> void {
+    stream().write(std::move(headers), std::move(data));
+}
+
 auto client_rpc_dispatch_t::abort(hpack::headers_t headers, const std::error_code& ec, const std::string& reason) -> void {
     stream().abort(std::move(headers), ec, reason);
     finalize();
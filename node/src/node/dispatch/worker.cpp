@@ -8,9 +8,12 @@ worker_rpc_dispatch_t::worker_rpc_dispatch_t(std::shared_ptr<stream_t> stream_,
     dispatch<incoming_tag>("W2C"),
     stream(stream_), // NOTE: Intentionally copy here to provide exception-safety guarantee.
     state(state_t::open),
-    callback(callback)
+    callback(callback),
+    first_response(0)
 {
     on<protocol::chunk>([&](const std::string& chunk) {
+        respond();
+
         std::lock_guard<std::mutex> lock(mutex);
 
         if (state == state_t::closed) {
@@ -25,6 +28,8 @@ worker_rpc_dispatch_t::worker_rpc_dispatch_t(std::shared_ptr<stream_t> stream_,
     });
 
     on<protocol::error>([&](const std::error_code& ec, const std::string& reason) {
+        respond();
+
         std::lock_guard<std::mutex> lock(mutex);
 
         if (state == state_t::closed) {
@@ -40,6 +45,8 @@ worker_rpc_dispatch_t::worker_rpc_dispatch_t(std::shared_ptr<stream_t> stream_,
     });
 
     on<protocol::choke>([&]() {
+        respond();
+
         std::lock_guard<std::mutex> lock(mutex);
 
         if (state == state_t::closed) {
@@ -74,6 +81,26 @@ worker_rpc_dispatch_t::discard(const std::error_code& ec) {
     }
 }
 
+boost::optional<worker_rpc_dispatch_t::clock_type::time_point>
+worker_rpc_dispatch_t::responded() const {
+    const auto value = first_response.load();
+    if (value == 0) {
+        return boost::none;
+    }
+
+    return clock_type::time_point(clock_type::duration(value));
+}
+
+void
+worker_rpc_dispatch_t::respond() {
+    if (first_response.load(std::memory_order_relaxed) != 0) {
+        return;
+    }
+
+    clock_type::rep expected = 0;
+    first_response.compare_exchange_strong(expected, clock_type::now().time_since_epoch().count());
+}
+
 void
 worker_rpc_dispatch_t::finalize(std::lock_guard<std::mutex>&, const std::error_code& ec) {
     // Ensure that we call this method only once no matter what.
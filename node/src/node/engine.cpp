@@ -1,8 +1,11 @@
 #include "engine.hpp"
 
+#include <algorithm>
+#include <iterator>
+
+#include <boost/lexical_cast.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm.hpp>
-#include <boost/range/numeric.hpp>
 
 #include <blackhole/logger.hpp>
 #include <blackhole/scope/holder.hpp>
@@ -31,6 +34,7 @@
 #include "cocaine/detail/service/node/dispatch/worker.hpp"
 #include "cocaine/detail/service/node/slave/control.hpp"
 
+#include "crashlog.hpp"
 #include "isometrics.hpp"
 #include "pool_observer.hpp"
 #include "stdext/clamp.hpp"
@@ -46,6 +50,13 @@ namespace node {
 
 namespace ph = std::placeholders;
 
+namespace {
+
+/// Time window of the queue depth moving average.
+constexpr std::chrono::seconds queue_depth_window(2);
+
+} // namespace
+
 engine_t::engine_t(context_t& context,
                    manifest_t manifest,
                    profile_t profile,
@@ -56,12 +67,15 @@ engine_t::engine_t(context_t& context,
     stopped(false),
     birthstamp(std::chrono::system_clock::now()),
     manifest_(std::move(manifest)),
-    profile_(profile),
+    profile_(std::move(profile)),
     auth(api::authentication(context, "core", manifest_.name)),
     loop(loop),
     pool_target{},
+    rebalance_pending(false),
     last_timeout(std::chrono::seconds(1)),
-    stats(context, manifest_.name, std::chrono::seconds(2))
+    stats(context, manifest_.name, queue_depth_window),
+    crashlogs(std::make_shared<crashlog_writer_t>(context, manifest_.name, profile_, stats.crashlogs, *loop)),
+    transitions(std::make_shared<slave::transitions_t>())
 {
     attach_pool_observer(std::move(observer));
     COCAINE_LOG_DEBUG(log, "overseer has been initialized");
@@ -72,15 +86,7 @@ engine_t::~engine_t() {
 }
 
 auto engine_t::active_workers() const -> std::uint32_t {
-    return pool.apply([&](const pool_type& pool) -> std::uint32_t {
-        std::uint32_t active = 0;
-        for (const auto& kv : pool) {
-            if (kv.second.active()) {
-                ++active;
-            }
-        }
-        return active;
-    });
+    return loads->active();
 }
 
 auto engine_t::pooled_workers_ids() const -> std::vector<std::string> {
@@ -95,25 +101,31 @@ auto engine_t::pooled_workers_ids() const -> std::vector<std::string> {
 }
 
 auto
-engine_t::start_isolate_metrics_poll() -> void
+engine_t::start_isolate_metrics_poll(std::shared_ptr<metrics_poller_t> poller) -> void
 {
-    auto isolate = profile_.apply([&](const profile_t& profile) {
-        return context.repository().get<api::isolate_t>(
+    if (!poller) {
+        throw error_t(cocaine::error::component_not_registered, "'isolate_metrics' wasn't set in config");
+    }
+
+    const auto& profile = profile_;
+    auto isolate = context.repository().get<api::isolate_t>(
         profile.isolate.type,
         context,
         *loop,
         manifest_.name,
         profile.isolate.type,
         profile.isolate.args);
-    });
 
-    metrics_retriever = metrics_retriever_t::make_and_ignite(
+    metrics_retriever = std::make_shared<metrics_retriever_t>(
         context,
         manifest_.name,
-        isolate,
+        std::move(isolate),
+        cocaine::format("{}/{}", profile.isolate.type, boost::lexical_cast<std::string>(profile.isolate.args)),
         shared_from_this(),
-        *loop,
-        observers);
+        poller->interval());
+
+    observers->emplace_back(metrics_retriever->make_observer());
+    poller->attach(metrics_retriever);
 }
 
 auto
@@ -129,7 +141,7 @@ engine_t::manifest() const {
 
 profile_t
 engine_t::profile() const {
-    return *profile_.synchronize();
+    return profile_;
 }
 
 void
@@ -138,20 +150,69 @@ engine_t::attach_pool_observer(std::shared_ptr<pool_observer> observer) {
 }
 
 auto engine_t::info(io::node::info::flags_t flags) const -> dynamic_t::object_t {
+    const auto& profile = profile_;
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto staleness = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(profile.info_staleness));
+
+    if (staleness.count() > 0) {
+        auto cached = info_cache.apply([&](const std::map<io::node::info::flags_t, info_snapshot_t>& cache) {
+            boost::optional<dynamic_t::object_t> result;
+
+            const auto it = cache.find(flags);
+            if (it != cache.end() && now - it->second.built <= staleness) {
+                result = it->second.info;
+            }
+
+            return result;
+        });
+
+        if (cached) {
+            // Uptime is cheap, hence always fresh.
+            (*cached)["uptime"] = uptime().count();
+            return std::move(*cached);
+        }
+    }
+
+    auto result = collect_info(flags, profile);
+
+    if (staleness.count() > 0) {
+        info_cache.apply([&](std::map<io::node::info::flags_t, info_snapshot_t>& cache) {
+            cache[flags] = info_snapshot_t{now, result};
+        });
+    }
+
+    return result;
+}
+
+auto engine_t::collect_info(io::node::info::flags_t flags, const profile_t& profile) const
+    -> dynamic_t::object_t
+{
     dynamic_t::object_t result;
 
     result["uptime"] = uptime().count();
 
-    auto profile = this->profile();
     cocaine::service::node::info::manifest_t(manifest(), flags).apply(result);
     cocaine::service::node::info::profile_t(profile, flags).apply(result);
 
     cocaine::service::node::info::info_collector_t collector(flags, &result);
-    collector.visit(stats.requests.accepted->load(), stats.requests.rejected->load());
+    collector.visit(stats.requests.accepted->load(), stats.requests.rejected->load(),
+        stats.requests.expired->load());
     collector.visit({profile.queue_limit, &queue, *stats.queue_depth});
     collector.visit(*stats.meter.get());
     collector.visit(*stats.timer.get());
     collector.visit({profile.pool_limit, stats.slaves.spawned->load(), stats.slaves.crashed->load(), &pool});
+    collector.visit(cocaine::service::node::info::rebalance_t{
+        stats.rebalance.invocations->load(),
+        stats.rebalance.coalesced->load(),
+        stats.rebalance.moved->load()
+    });
+    collector.visit(*stats.latency);
+
+    if (flags & io::node::info::state_trace) {
+        collector.visit(*transitions);
+    }
 
     return result;
 }
@@ -177,8 +238,34 @@ auto engine_t::control_population(boost::optional<std::size_t> count) -> void {
     rebalance_slaves();
 }
 
+auto engine_t::warm_up() -> void {
+    const auto& profile = profile_;
+    if (profile.warm.spare == 0) {
+        return;
+    }
+
+    COCAINE_LOG_INFO(log, "warming up the pool with {} spare slaves", profile.warm.spare);
+    loop->post(std::bind(&engine_t::rebalance_slaves, shared_from_this()));
+}
+
 namespace {
 
+auto deadline_of(const event_t& event, const profile_t& profile) -> load_t::time_point {
+    std::chrono::milliseconds request_timeout(profile.request_timeout());
+    if (auto timeout_from_header = hpack::header::convert_first<std::uint64_t>(event.headers, "request_timeout")) {
+        request_timeout = std::chrono::milliseconds(*timeout_from_header);
+    }
+
+    const auto deadline = event.birthstamp + request_timeout;
+
+    // TODO: Drop due to replacement with header.
+    if (event.deadline && *event.deadline < deadline) {
+        return *event.deadline;
+    }
+
+    return deadline;
+}
+
 struct tx_stream_t : public api::stream_t {
     std::shared_ptr<client_rpc_dispatch_t> dispatch;
 
@@ -237,41 +324,86 @@ auto engine_t::enqueue(event_t event, std::shared_ptr<api::stream_t> rx)
 
     auto tx = std::make_shared<tx_stream_t>();
 
-    const auto profile = this->profile();
+    const auto& profile = profile_;
     const auto limit = profile.queue_limit;
 
     try {
-        pool.apply([&](pool_type& pool) {
-            queue.apply([&](queue_type& queue) {
-                if (limit > 0 && queue.size() >= limit) {
-                    throw std::system_error(error::queue_is_full);
-                }
+        // Admission is checked under the queue lock only. The vacant capacity estimation is
+        // approximate by its nature, so there is no need to hold the pool lock while pushing.
+        std::size_t vacant = 0;
+        if (limit == 0) {
+            // Without the pool lock the pressure may momentarily exceed the capacity, for example
+            // while the pool limit is being lowered, so the subtraction must not wrap around.
+            const auto capacity = profile.pool_limit * profile.concurrency;
+            const auto pressure = pool_pressure();
+            vacant = capacity > pressure ? capacity - pressure : 0;
+        }
 
-                tx->dispatch = std::make_shared<client_rpc_dispatch_t>(manifest().name);
-                auto load = load_t{
-                    std::move(event),
-                    trace_t::current(),
-                    tx->dispatch, // Explicitly copy.
-                    std::move(rx)
-                };
+        const auto deadline = deadline_of(event, profile);
+        const auto edf = profile.queue_discipline == "edf";
+        const auto fair = !profile.fair.header.empty();
 
-                if (limit == 0) {
-                    auto pressure = pool_pressure(pool);
-                    auto vacant = profile.pool_limit * profile.concurrency - pressure;
+        std::string flow;
+        double weight = 1.0;
+        if (fair) {
+            if (auto value = hpack::header::convert_first<std::string>(event.headers, profile.fair.header)) {
+                flow = *value;
+            }
 
-                    if (queue.size() >= vacant) {
-                        throw std::system_error(error::queue_is_full);
-                    }
+            const auto it = profile.fair.weights.find(flow);
+            if (it != profile.fair.weights.end()) {
+                weight = it->second;
+            }
+        }
+
+        // Pushed out load of the heaviest client, if any.
+        boost::optional<load_t> evicted;
+
+        queue.apply([&](queue_type& queue) {
+            const auto full = (limit > 0 && queue.size() >= limit) || (limit == 0 && queue.size() >= vacant);
+
+            if (full) {
+                // With fair queuing the overloading client pays for the overload rather than
+                // the newcomer, unless it is the newcomer itself.
+                if (fair) {
+                    evicted = queue.evict(flow);
                 }
 
-                queue.push_back(load);
-                stats.queue_depth->add(queue.size());
+                if (!evicted) {
+                    throw std::system_error(error::queue_is_full);
+                }
+            }
 
-                stats.requests.accepted->fetch_add(1);
-                rebalance_events(pool, queue);
-            });
+            tx->dispatch = std::make_shared<client_rpc_dispatch_t>(manifest_.name);
+
+            load_t load{
+                std::move(event),
+                trace_t::current(),
+                tx->dispatch, // Explicitly copy.
+                std::move(rx),
+                deadline
+            };
+
+            queue.push(flow, weight, std::move(load), edf);
+
+            stats.queue_depth->add(queue.size());
         });
 
+        stats.requests.accepted->fetch_add(1);
+
+        if (evicted) {
+            stats.requests.rejected->fetch_add(1);
+
+            trace_t::restore_scope_t scope(evicted->trace);
+            COCAINE_LOG_WARNING(log, "event {} has been pushed out of the full queue", evicted->event.name);
+            try {
+                evicted->downstream->error({}, error::queue_is_full, "the queue is full");
+            } catch (const std::system_error& err) {
+                COCAINE_LOG_DEBUG(log, "failed to notify eviction: {}", error::to_string(err));
+            }
+        }
+
+        rebalance_events();
         rebalance_slaves();
     } catch (...) {
         stats.requests.rejected->fetch_add(1);
@@ -294,9 +426,20 @@ auto engine_t::cancel() -> void {
     this->stats.deregister();
     this->stopped = true;
     this->control_population(boost::none);
-    this->pool->clear();
+    this->sweep_timer.apply([&](std::unique_ptr<asio::deadline_timer>& timer) {
+        timer.reset();
+    });
+    this->recycle_timer.apply([&](std::unique_ptr<asio::deadline_timer>& timer) {
+        timer.reset();
+    });
+    this->pool.apply([&](pool_type& pool) {
+        pool.clear();
+        recycling.clear();
+        loads->clear();
+    });
     this->on_spawn_rate_timer->reset();
     this->observers->clear();
+    this->crashlogs->cancel();
 }
 
 auto engine_t::spawn(pool_type& pool) -> void {
@@ -304,8 +447,9 @@ auto engine_t::spawn(pool_type& pool) -> void {
 }
 
 auto engine_t::spawn(id_t id, pool_type& pool) -> void {
-    const auto profile = this->profile();
-    if (pool.size() >= profile.pool_limit) {
+    const auto& profile = profile_;
+    // Replacements of slaves being recycled are allowed to exceed the limit temporarily.
+    if (pool.size() >= profile.pool_limit + recycling.size()) {
         throw std::system_error(error::pool_is_full, "the pool is full");
     }
 
@@ -313,11 +457,29 @@ auto engine_t::spawn(id_t id, pool_type& pool) -> void {
 
     // It is guaranteed that the cleanup handler will not be invoked from within the slave's
     // constructor.
-    pool.insert(std::make_pair(
-        id.id(),
-        slave_t(context, id, manifest(), profile, auth, *loop,
-            std::bind(&engine_t::on_slave_death, shared_from_this(), ph::_1, id.id()))
-    ));
+    slave::balance_handler_t balance{
+        std::bind(&engine_t::on_slave_load, shared_from_this(), id.id(), ph::_1),
+        std::bind(&engine_t::on_slave_activity, shared_from_this(), id.id(), ph::_1)
+    };
+
+    // Start tracking before construction to catch early notifications. The slave can't become
+    // active from within its constructor, so there is nothing to lose.
+    loads->insert(id.id());
+
+    try {
+        pool.insert(std::make_pair(
+            id.id(),
+            slave_t(context, id, manifest_, profile, auth, *loop,
+                std::bind(&engine_t::on_slave_death, shared_from_this(), ph::_1, id.id()),
+                std::move(balance),
+                std::shared_ptr<util::histogram_t>(stats.latency, &stats.latency->response),
+                crashlogs,
+                transitions)
+        ));
+    } catch (...) {
+        loads->erase(id.id());
+        throw;
+    }
 
     stats.slaves.spawned->fetch_add(1);
 }
@@ -327,41 +489,35 @@ auto engine_t::assign(slave_t& slave, load_t& load) -> void {
 
     auto& event = load.event;
 
-    std::chrono::milliseconds request_timeout(profile().request_timeout());
-    if (auto timeout_from_header = hpack::header::convert_first<std::uint64_t>(event.headers, "request_timeout")) {
-        request_timeout = std::chrono::milliseconds(*timeout_from_header);
-    }
-
-    const auto drop_event = [&] {
-        COCAINE_LOG_WARNING(log, "event {} has expired, dropping", event.name);
-        try {
-            load.downstream->error({}, error::deadline_error, "the event has expired in the queue");
-        } catch (const std::system_error& err) {
-            COCAINE_LOG_DEBUG(log, "failed to notify assignment failure: {}", error::to_string(err));
-        }
-    };
-
-    if (event.birthstamp + request_timeout < std::chrono::high_resolution_clock::now()) {
-        drop_event();
+    if (load.deadline < std::chrono::high_resolution_clock::now()) {
+        drop(load);
         return;
     }
 
-    // TODO: Drop due to replacement with header.
-    if (event.deadline && *event.deadline < std::chrono::high_resolution_clock::now()) {
-        drop_event();
-        return;
-    }
+    const auto injected = std::chrono::high_resolution_clock::now();
+    stats.latency->queue.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(injected - event.birthstamp).count());
 
     auto self = shared_from_this();
     auto timer = std::make_shared<metrics::timer_t::context_t>(stats.timer->context());
-    slave.inject(load, [this, self, timer](std::uint64_t) {
-        // TODO: Hack, but at least it saves from the deadlock.
-        loop->post([&, self] {
-            rebalance_events();
-        });
+    slave.inject(load, [self, timer, injected](std::uint64_t) {
+        self->stats.latency->channel.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - injected).count());
+
+        // Rebalancing is deferred to the loop to avoid deadlock with the slave's channels lock.
+        self->schedule_rebalance_events();
     });
 }
 
+auto engine_t::drop(load_t& load) -> void {
+    COCAINE_LOG_WARNING(log, "event {} has expired, dropping", load.event.name);
+    try {
+        load.downstream->error({}, error::deadline_error, "the event has expired in the queue");
+    } catch (const std::system_error& err) {
+        COCAINE_LOG_DEBUG(log, "failed to notify assignment failure: {}", error::to_string(err));
+    }
+}
+
 auto engine_t::despawn(const std::string& id, despawn_policy_t policy) -> void {
 
     const auto was_despawned = pool.apply([&](pool_type& pool) {
@@ -373,6 +529,7 @@ auto engine_t::despawn(const std::string& id, despawn_policy_t policy) -> void {
                 break;
             case despawn_policy_t::force:
                 pool.erase(it);
+                loads->erase(id);
                 loop->post(std::bind(&engine_t::rebalance_slaves, shared_from_this()));
                 return true;
                 break;
@@ -409,7 +566,9 @@ auto engine_t::on_handshake(const std::string& id, std::shared_ptr<session_t> se
 
         COCAINE_LOG_DEBUG(log, "activating slave");
         try {
-            return it->second.activate(std::move(session), std::move(stream));
+            auto control = it->second.activate(std::move(session), std::move(stream));
+            complete_recycling(pool, id);
+            return control;
         } catch (const std::exception& err) {
             // The slave can be in invalid state; broken, for example, or because the overseer is
             // overloaded. In fact I hope it never happens.
@@ -423,10 +582,7 @@ auto engine_t::on_handshake(const std::string& id, std::shared_ptr<session_t> se
     });
 
     if (control) {
-        auto self = shared_from_this();
-        loop->post([&, self] {
-            rebalance_events();
-        });
+        schedule_rebalance_events();
 
         observers.apply([&](const observers_type& observers) {
             for(auto& o : observers) {
@@ -474,7 +630,10 @@ auto engine_t::on_slave_death(const std::error_code& ec, std::string uuid) -> vo
         if (it != pool.end()) {
             it->second.terminate(ec);
             pool.erase(it);
+            loads->erase(uuid);
         }
+
+        abandon_recycling(uuid);
     });
 
     observers.apply([&](const observers_type& observers) {
@@ -486,6 +645,185 @@ auto engine_t::on_slave_death(const std::error_code& ec, std::string uuid) -> vo
     loop->post(std::bind(&engine_t::rebalance_slaves, shared_from_this()));
 }
 
+auto engine_t::start_queue_sweep() -> void {
+    if (profile_.queue_sweep == 0) {
+        return;
+    }
+
+    sweep_timer.apply([&](std::unique_ptr<asio::deadline_timer>& timer) {
+        timer.reset(new asio::deadline_timer(*loop));
+    });
+
+    schedule_queue_sweep();
+}
+
+auto engine_t::schedule_queue_sweep() -> void {
+    const auto interval = static_cast<long>(1000 * profile_.queue_sweep);
+
+    sweep_timer.apply([&](std::unique_ptr<asio::deadline_timer>& timer) {
+        if (!timer) {
+            return;
+        }
+
+        timer->expires_from_now(boost::posix_time::milliseconds(std::max(interval, 1L)));
+        timer->async_wait(std::bind(&engine_t::on_queue_sweep, shared_from_this(), ph::_1));
+    });
+}
+
+auto engine_t::on_queue_sweep(const std::error_code& ec) -> void {
+    if (ec || stopped) {
+        return;
+    }
+
+    const auto now = std::chrono::high_resolution_clock::now();
+
+    std::vector<load_t> expired;
+    queue.apply([&](queue_type& queue) {
+        expired = queue.expire(now);
+
+        if (!expired.empty()) {
+            stats.queue_depth->add(queue.size());
+        }
+    });
+
+    if (!expired.empty()) {
+        COCAINE_LOG_INFO(log, "dropping {} expired events from the queue", expired.size());
+        stats.requests.expired->fetch_add(static_cast<std::int64_t>(expired.size()));
+
+        // Notify clients outside the queue lock.
+        for (auto& load : expired) {
+            trace_t::restore_scope_t scope(load.trace);
+            drop(load);
+        }
+    }
+
+    schedule_queue_sweep();
+}
+
+auto engine_t::start_recycling() -> void {
+    const auto& profile = profile_;
+    if (profile.recycle.requests == 0 && profile.recycle.uptime == 0 && profile.recycle.memory == 0) {
+        return;
+    }
+
+    recycle_timer.apply([&](std::unique_ptr<asio::deadline_timer>& timer) {
+        timer.reset(new asio::deadline_timer(*loop));
+    });
+
+    schedule_recycle_check();
+}
+
+auto engine_t::schedule_recycle_check() -> void {
+    const auto interval = static_cast<long>(1000 * profile_.recycle.interval);
+
+    recycle_timer.apply([&](std::unique_ptr<asio::deadline_timer>& timer) {
+        if (!timer) {
+            return;
+        }
+
+        timer->expires_from_now(boost::posix_time::milliseconds(std::max(interval, 1L)));
+        timer->async_wait(std::bind(&engine_t::on_recycle_check, shared_from_this(), ph::_1));
+    });
+}
+
+auto engine_t::on_recycle_check(const std::error_code& ec) -> void {
+    if (ec || stopped) {
+        return;
+    }
+
+    const auto& profile = profile_;
+    const auto& limits = profile.recycle;
+
+    // Collected before taking the pool lock, because the metrics table has its own one.
+    std::unordered_map<std::string, std::uint64_t> memory;
+    if (limits.memory > 0 && metrics_retriever) {
+        memory = metrics_retriever->memory_usage();
+    }
+
+    pool.apply([&](pool_type& pool) {
+        std::vector<std::pair<std::string, const char*>> expired;
+
+        for (const auto& it : pool) {
+            const auto& slave = it.second;
+
+            if (!slave.active() || recycling.count(it.first) > 0) {
+                continue;
+            }
+
+            if (limits.requests > 0 && slave.stats().total >= limits.requests) {
+                expired.emplace_back(it.first, "requests");
+            } else if (limits.uptime > 0 && slave.uptime() >= limits.uptime) {
+                expired.emplace_back(it.first, "uptime");
+            } else if (limits.memory > 0) {
+                const auto usage = memory.find(it.first);
+                if (usage != memory.end() && usage->second > limits.memory) {
+                    expired.emplace_back(it.first, "memory");
+                }
+            }
+        }
+
+        for (const auto& slave : expired) {
+            id_t replacement;
+
+            COCAINE_LOG_INFO(log, "recycling slave after reaching its {} limit", slave.second, blackhole::attribute_list{
+                {"uuid", slave.first},
+                {"replacement", replacement.id()},
+            });
+
+            // Registered before spawning to let the replacement exceed the pool limit.
+            recycling[slave.first] = replacement.id();
+
+            try {
+                spawn(replacement, pool);
+            } catch (const std::exception& err) {
+                COCAINE_LOG_WARNING(log, "failed to spawn replacement slave: {}", err.what());
+                recycling.erase(slave.first);
+                break;
+            }
+        }
+    });
+
+    schedule_recycle_check();
+}
+
+auto engine_t::complete_recycling(pool_type& pool, const std::string& replacement) -> void {
+    for (auto it = recycling.begin(); it != recycling.end(); ++it) {
+        if (it->second != replacement) {
+            continue;
+        }
+
+        const auto slave = pool.find(it->first);
+        recycling.erase(it);
+
+        if (slave != pool.end()) {
+            try {
+                COCAINE_LOG_DEBUG(log, "sealing recycled slave", {{"uuid", slave->first}});
+                slave->second.seal();
+                stats.slaves.recycled->fetch_add(1);
+            } catch (const std::exception& err) {
+                COCAINE_LOG_WARNING(log, "failed to seal recycled slave: {}", err.what());
+            }
+        }
+
+        return;
+    }
+}
+
+auto engine_t::abandon_recycling(const std::string& id) -> void {
+    // Either the replaced slave has died on its own, then its replacement becomes a regular one, or
+    // the replacement has died, then the replaced slave is checked again later.
+    if (recycling.erase(id) > 0) {
+        return;
+    }
+
+    for (auto it = recycling.begin(); it != recycling.end(); ++it) {
+        if (it->second == id) {
+            recycling.erase(it);
+            return;
+        }
+    }
+}
+
 auto engine_t::on_spawn_rate_timeout(const std::error_code&) -> void {
     on_spawn_rate_timer.apply([&](std::unique_ptr<asio::deadline_timer>& timer) {
         timer.reset();
@@ -495,11 +833,30 @@ auto engine_t::on_spawn_rate_timeout(const std::error_code&) -> void {
     rebalance_slaves();
 }
 
+auto engine_t::on_slave_load(const std::string& uuid, std::uint64_t load) -> void {
+    loads->load(uuid, load);
+}
+
+auto engine_t::on_slave_activity(const std::string& uuid, bool active) -> void {
+    loads->activity(uuid, active);
+}
+
 auto engine_t::select_slave(pool_type& pool) -> boost::optional<slave_t&> {
-    auto concurrency = profile().concurrency;
-    return select_slave(pool, [&](const slave_t& slave) -> bool {
-        return slave.active() && slave.load() < concurrency;
-    });
+    const auto concurrency = profile_.concurrency;
+
+    // The id pointer remains valid after the index lock is released, because slaves are erased
+    // from the index only under the pool lock, which is held by the caller.
+    const auto id = loads->select(concurrency);
+    if (id == nullptr) {
+        return boost::none;
+    }
+
+    auto it = pool.find(*id);
+    if (it == pool.end()) {
+        return boost::none;
+    }
+
+    return it->second;
 }
 
 auto engine_t::select_slave(pool_type& pool, std::function<bool(const slave_t& slave)> filter) -> boost::optional<slave_t&> {
@@ -516,17 +873,30 @@ auto engine_t::select_slave(pool_type& pool, std::function<bool(const slave_t& s
     }
 }
 
-auto engine_t::pool_pressure(pool_type& pool) -> std::size_t {
-    return boost::accumulate(pool |
-        boost::adaptors::map_values |
-        boost::adaptors::transformed(+[](const slave_t& slave) {
-            return slave.load();
-        }),
-        0
-    );
+auto engine_t::pool_pressure() const -> std::size_t {
+    return loads->pressure();
+}
+
+auto engine_t::schedule_rebalance_events() -> void {
+    if (rebalance_pending.exchange(true)) {
+        stats.rebalance.coalesced->fetch_add(1);
+        return;
+    }
+
+    auto self = shared_from_this();
+    loop->post([self] {
+        // Reset the flag before draining, so requests arrived during the pass schedule a new one.
+        self->rebalance_pending = false;
+        self->rebalance_events();
+    });
 }
 
 auto engine_t::rebalance_events() -> void {
+    // Most of completions occur with the empty queue, there is no need to lock the pool then.
+    if (queue->empty()) {
+        return;
+    }
+
     pool.apply([&](pool_type& pool) {
         queue.apply([&](queue_type& queue) {
             rebalance_events(pool, queue);
@@ -535,10 +905,14 @@ auto engine_t::rebalance_events() -> void {
 }
 
 auto engine_t::rebalance_events(pool_type& pool, queue_type& queue) -> void {
-    if (pool.empty()) {
+    if (pool.empty() || queue.empty()) {
         return;
     }
 
+    stats.rebalance.invocations->fetch_add(1);
+
+    std::int64_t moved = 0;
+
     COCAINE_LOG_DEBUG(log, "rebalancing events queue");
     while (!queue.empty()) {
         auto& load = queue.front();
@@ -550,8 +924,8 @@ auto engine_t::rebalance_events(pool_type& pool, queue_type& queue) -> void {
                 // The slave may become invalid and reject the assignment or reject for any
                 // other reasons. We pop the channel only on successful assignment to
                 // achieve strong exception guarantee.
-                queue.pop_front();
-                stats.queue_depth->add(queue.size());
+                queue.pop();
+                ++moved;
             } catch (const std::exception& err) {
                 COCAINE_LOG_WARNING(log, "slave has rejected assignment: {}", err.what());
                 loop->post([&] {
@@ -564,6 +938,11 @@ auto engine_t::rebalance_events(pool_type& pool, queue_type& queue) -> void {
             break;
         }
     }
+
+    if (moved > 0) {
+        stats.rebalance.moved->fetch_add(moved);
+        stats.queue_depth->add(queue.size());
+    }
 }
 
 auto engine_t::rebalance_slaves() -> void {
@@ -572,7 +951,7 @@ auto engine_t::rebalance_slaves() -> void {
     }
 
     const auto load = queue->size();
-    const auto profile = this->profile();
+    const auto& profile = profile_;
     const auto manual_target = *this->pool_target.synchronize();
 
     std::size_t target;
@@ -583,8 +962,9 @@ auto engine_t::rebalance_slaves() -> void {
             target = (load + profile.grow_threshold - 1) / profile.grow_threshold;
         } else {
             target = pool.apply([&](pool_type& pool) {
-                auto pressure = pool_pressure(pool);
-                auto vacant = pool.size() * profile.concurrency - pressure;
+                auto pressure = pool_pressure();
+                auto capacity = pool.size() * profile.concurrency;
+                auto vacant = capacity > pressure ? capacity - pressure : 0;
 
                 std::size_t lack = 0;
                 if (load < vacant) {
@@ -596,6 +976,8 @@ auto engine_t::rebalance_slaves() -> void {
                 return pool.size() + lack;
             });
         }
+
+        target = std::max(target, warm_target(profile, load));
     }
 
     // Bound current pool target between [0; limit].
@@ -661,6 +1043,30 @@ auto engine_t::rebalance_slaves() -> void {
     });
 }
 
+auto engine_t::warm_target(const profile_t& profile, std::size_t load) -> std::size_t {
+    if (profile.warm.spare == 0 && profile.warm.horizon == 0) {
+        return 0;
+    }
+
+    auto demand = static_cast<double>(pool_pressure() + load);
+
+    if (profile.warm.horizon > 0) {
+        auto& meter = *stats.meter;
+        const auto acceleration = meter.m01rate() - meter.m05rate();
+        demand += std::max(0.0, acceleration * profile.warm.horizon);
+
+        // The moving average lags behind the queue depth by about its window, so their difference
+        // approximates the growth during that window.
+        const auto window = std::chrono::duration<double>(queue_depth_window).count();
+        const auto growth = (static_cast<double>(load) - stats.queue_depth->get()) / window;
+        demand += std::max(0.0, growth * profile.warm.horizon);
+    }
+
+    const auto required = static_cast<std::size_t>(std::ceil(demand / profile.concurrency));
+
+    return required + profile.warm.spare;
+}
+
 } // namespace node
 } // namespace service
 } // namespace detail
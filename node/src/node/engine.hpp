@@ -1,7 +1,9 @@
 #pragma once
 
 #include <deque>
+#include <map>
 #include <string>
+#include <unordered_map>
 
 #include <boost/optional.hpp>
 
@@ -20,6 +22,9 @@
 #include "cocaine/detail/service/node/slave/load.hpp"
 #include "cocaine/detail/service/node/stats.hpp"
 
+#include "event_queue.hpp"
+#include "load_index.hpp"
+
 namespace cocaine {
 namespace detail {
 namespace service {
@@ -36,7 +41,7 @@ class engine_t : public std::enable_shared_from_this<engine_t> {
 public:
     enum class despawn_policy_t { graceful, force };
 
-    typedef std::deque<load_t> queue_type;
+    typedef event_queue_t queue_type;
     typedef std::unordered_map<std::string, slave_t> pool_type;
 
     const std::unique_ptr<cocaine::logging::logger_t> log;
@@ -52,7 +57,10 @@ public:
     const manifest_t manifest_;
 
     /// The application profile.
-    synchronized<profile_t> profile_;
+    ///
+    /// Immutable for the engine lifetime, so readers on the request path never copy it nor take
+    /// any lock.
+    const profile_t profile_;
 
     std::shared_ptr<api::authentication_t> auth;
 
@@ -62,6 +70,13 @@ public:
     /// Slave pool.
     // TODO: Seems like we need multichannel queue system with size 1 and timeouts.
     synchronized<pool_type> pool;
+
+    /// Pooled slaves indexed by their load.
+    ///
+    /// Updated incrementally by slaves themselves on each load or activity change, so it must be
+    /// locked after the pool lock, if any, and never held while calling into slaves.
+    synchronized<load_index_t> loads;
+
     synchronized<boost::optional<std::size_t>> pool_target;
     synchronized<std::unique_ptr<asio::deadline_timer>> on_spawn_rate_timer;
     std::chrono::system_clock::time_point last_failed;
@@ -73,13 +88,40 @@ public:
     /// Pending queue.
     synchronized<queue_type> queue;
 
+    /// Timer for proactive sweeps of expired events from the queue, if enabled in the profile.
+    synchronized<std::unique_ptr<asio::deadline_timer>> sweep_timer;
+
+    /// Timer for periodic checks of the slaves recycling limits, if enabled in the profile.
+    synchronized<std::unique_ptr<asio::deadline_timer>> recycle_timer;
+
+    /// Slaves being recycled mapped to their replacements, which are spawned, but not active yet.
+    ///
+    /// Guarded by the pool lock.
+    std::unordered_map<std::string, std::string> recycling;
+
+    /// Set when the events queue rebalancing is already posted to the loop, but not started yet.
+    std::atomic<bool> rebalance_pending;
+
     /// Statistics.
     stats_t stats;
 
-    /// Isolation daemon's workers metrics sampler.
-    /// Poll sequence should be initialized explicitly with
-    /// metrics_retriever_t::ignite_poll method or implicitly
-    /// within metrics_retriever_t::make_and_ignite.
+    /// Crashlogs upload queue shared by all slaves.
+    std::shared_ptr<crashlog_writer_t> crashlogs;
+
+    /// Recent state transitions of all slaves, reported on demand only.
+    std::shared_ptr<slave::transitions_t> transitions;
+
+    struct info_snapshot_t {
+        std::chrono::steady_clock::time_point built;
+        dynamic_t::object_t info;
+    };
+
+    /// Info snapshots cached per requested flags, so frequent monitoring scrapes neither rebuild
+    /// them nor take the pool and queue locks shared with the request path.
+    mutable synchronized<std::map<io::node::info::flags_t, info_snapshot_t>> info_cache;
+
+    /// Isolation daemon's workers metrics table, attached to the node-wide poller with
+    /// start_isolate_metrics_poll.
     std::shared_ptr<metrics_retriever_t> metrics_retriever;
 public:
     engine_t(context_t& context,
@@ -143,6 +185,15 @@ public:
     /// automatic policy.
     auto control_population(boost::optional<std::size_t> count) -> void;
 
+    /// Populates the warm pool ahead of any traffic if it's configured in the profile.
+    auto warm_up() -> void;
+
+    /// Starts periodic sweeps of expired events from the queue if it's configured in the profile.
+    auto start_queue_sweep() -> void;
+
+    /// Starts periodic checks of the slaves recycling limits if any is configured in the profile.
+    auto start_recycling() -> void;
+
     /// Creates a new handshake dispatch, which will be consumed after a new incoming connection
     /// attached.
     ///
@@ -168,9 +219,15 @@ public:
     // case we can't call engine_t::shared_from_this() (needed in poll object
     // construction) from engine_t::ctor. stop_isolate_metrics_poll is
     // currently unused, defined for symmetry.
-    auto start_isolate_metrics_poll() -> void;
+    //
+    // Workers metrics are polled by the node-wide poller, which is null if isolate metrics are
+    // disabled in the node config.
+    auto start_isolate_metrics_poll(std::shared_ptr<metrics_poller_t> poller) -> void;
     auto stop_isolate_metrics_poll() -> void;
 private:
+    /// Builds the info from scratch.
+    auto collect_info(io::node::info::flags_t flags, const profile_t& profile) const -> dynamic_t::object_t;
+
     /// Spawns a slave using current manifest and profile.
     auto spawn(pool_type& pool) -> void;
 
@@ -180,6 +237,9 @@ private:
     /// \warning must be called under the pool lock.
     auto assign(slave_t& slave, load_t& load) -> void;
 
+    /// Notifies the client that the event has expired while waiting in the queue.
+    auto drop(load_t& load) -> void;
+
     /// Seals the worker, preventing it from new requests.
     ///
     /// Then forces the slave to send terminate event. Starts the timer. On timeout or on response
@@ -191,17 +251,65 @@ private:
 
     auto on_slave_death(const std::error_code& ec, std::string uuid) -> void;
 
+    auto on_slave_load(const std::string& uuid, std::uint64_t load) -> void;
+    auto on_slave_activity(const std::string& uuid, bool active) -> void;
+
+    /// Selects the least loaded active slave, which is able to accept a new event.
+    ///
+    /// \warning must be called under the pool lock.
     auto select_slave(pool_type& pool) -> boost::optional<slave_t&>;
     auto select_slave(pool_type& pool, std::function<bool(const slave_t& slave)> filter) -> boost::optional<slave_t&>;
 
-    auto pool_pressure(pool_type& pool) -> std::size_t;
+    /// Returns the cumulative load over all pooled slaves.
+    auto pool_pressure() const -> std::size_t;
+
+    /// Posts the events queue rebalancing to the loop unless it is already pending.
+    ///
+    /// All requests arrived before the pending pass starts are coalesced into it.
+    auto schedule_rebalance_events() -> void;
 
     auto rebalance_events() -> void;
+
+    /// Drains the queue into slaves until either it becomes empty or there is no vacant capacity
+    /// left.
+    ///
+    /// \warning must be called under both pool and queue locks.
     auto rebalance_events(pool_type& pool, queue_type& queue) -> void;
 
     auto rebalance_slaves() -> void;
 
+    /// Returns the number of slaves required to handle both the current and the forecasted load
+    /// plus the configured number of spare slaves, or zero if the warm pool is disabled.
+    ///
+    /// The forecast extrapolates both the arrival rate acceleration, i.e. the excess of the short
+    /// term rate over the long term one, and the queue growth rate over the configured horizon.
+    auto warm_target(const profile_t& profile, std::size_t load) -> std::size_t;
+
     auto on_spawn_rate_timeout(const std::error_code& ec) -> void;
+
+    auto schedule_queue_sweep() -> void;
+
+    /// Drops all expired events from the queue, then reschedules itself.
+    auto on_queue_sweep(const std::error_code& ec) -> void;
+
+    auto schedule_recycle_check() -> void;
+
+    /// Spawns replacements for active slaves that have reached any of the recycling limits, then
+    /// reschedules itself.
+    ///
+    /// The slave is sealed only after its replacement becomes active, so the pool capacity never
+    /// dips while recycling.
+    auto on_recycle_check(const std::error_code& ec) -> void;
+
+    /// Seals the slave replaced by the given one, if any.
+    ///
+    /// \warning must be called under the pool lock.
+    auto complete_recycling(pool_type& pool, const std::string& replacement) -> void;
+
+    /// Forgets about recycling the given slave, either the replaced or the replacement one.
+    ///
+    /// \warning must be called under the pool lock.
+    auto abandon_recycling(const std::string& id) -> void;
 };
 
 }  // namespace node
@@ -0,0 +1,197 @@
+#include "event_queue.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include <boost/assert.hpp>
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+event_queue_t::event_queue_t() :
+    turn(false),
+    total(0)
+{}
+
+auto event_queue_t::size() const noexcept -> std::size_t {
+    return total;
+}
+
+auto event_queue_t::empty() const noexcept -> bool {
+    return total == 0;
+}
+
+auto event_queue_t::push(const std::string& key, double weight, load_t load, bool edf) -> void {
+    BOOST_ASSERT(weight > 0);
+
+    auto it = flows.find(key);
+    if (it == flows.end()) {
+        it = flows.insert(std::make_pair(key, flow_t{{}, weight, 0})).first;
+        active.push_back(&*it);
+    }
+
+    auto& flow = it->second;
+    flow.weight = weight;
+
+    birthstamps.insert(load.event.birthstamp);
+
+    if (edf) {
+        // Loads with equal deadlines are kept in their arrival order.
+        const auto position = std::upper_bound(flow.loads.begin(), flow.loads.end(), load.deadline,
+            [](const time_point& deadline, const load_t& load) -> bool {
+                return deadline < load.deadline;
+            }
+        );
+
+        flow.loads.insert(position, std::move(load));
+    } else {
+        flow.loads.push_back(std::move(load));
+    }
+
+    ++total;
+}
+
+auto event_queue_t::front() -> load_t& {
+    BOOST_ASSERT(!empty());
+
+    while (true) {
+        auto& flow = active.front()->second;
+
+        if (!turn) {
+            flow.deficit += flow.weight;
+            turn = true;
+        }
+
+        if (flow.deficit >= 1.0) {
+            return flow.loads.front();
+        }
+
+        rotate();
+    }
+}
+
+auto event_queue_t::pop() -> void {
+    // Makes sure the front flow has been charged with its quantum.
+    front();
+
+    auto value = active.front();
+    auto& flow = value->second;
+
+    forget(flow.loads.front());
+    flow.loads.pop_front();
+    flow.deficit -= 1.0;
+    --total;
+
+    if (flow.loads.empty()) {
+        remove(value);
+    }
+}
+
+auto event_queue_t::evict(const std::string& key) -> boost::optional<load_t> {
+    if (active.empty()) {
+        return boost::none;
+    }
+
+    const auto longest = *std::max_element(active.begin(), active.end(),
+        [](const value_type* lhs, const value_type* rhs) -> bool {
+            return lhs->second.loads.size() < rhs->second.loads.size();
+        }
+    );
+
+    std::size_t own = 0;
+    const auto it = flows.find(key);
+    if (it != flows.end()) {
+        own = it->second.loads.size();
+    }
+
+    if (longest->second.loads.size() <= own + 1) {
+        return boost::none;
+    }
+
+    forget(longest->second.loads.back());
+
+    boost::optional<load_t> load(std::move(longest->second.loads.back()));
+    longest->second.loads.pop_back();
+    --total;
+
+    if (longest->second.loads.empty()) {
+        remove(longest);
+    }
+
+    return load;
+}
+
+auto event_queue_t::expire(time_point now) -> std::vector<load_t> {
+    std::vector<load_t> expired;
+
+    std::vector<value_type*> drained;
+    for (auto value : active) {
+        auto& loads = value->second.loads;
+
+        // Keeps the relative order of the remaining loads, which is required for both orderings.
+        const auto it = std::stable_partition(loads.begin(), loads.end(), [&](const load_t& load) {
+            return !(load.deadline < now);
+        });
+
+        if (it == loads.end()) {
+            continue;
+        }
+
+        total -= static_cast<std::size_t>(std::distance(it, loads.end()));
+        std::for_each(it, loads.end(), [&](const load_t& load) {
+            forget(load);
+        });
+        std::move(it, loads.end(), std::back_inserter(expired));
+        loads.erase(it, loads.end());
+
+        if (loads.empty()) {
+            drained.push_back(value);
+        }
+    }
+
+    for (auto value : drained) {
+        remove(value);
+    }
+
+    return expired;
+}
+
+auto event_queue_t::oldest() const -> boost::optional<time_point> {
+    if (birthstamps.empty()) {
+        return boost::none;
+    }
+
+    return *birthstamps.begin();
+}
+
+auto event_queue_t::forget(const load_t& load) -> void {
+    const auto it = birthstamps.find(load.event.birthstamp);
+    BOOST_ASSERT(it != birthstamps.end());
+
+    birthstamps.erase(it);
+}
+
+auto event_queue_t::remove(value_type* value) -> void {
+    const auto it = std::find(active.begin(), active.end(), value);
+    BOOST_ASSERT(it != active.end());
+
+    if (it == active.begin()) {
+        turn = false;
+    }
+
+    active.erase(it);
+    flows.erase(flows.find(value->first));
+}
+
+auto event_queue_t::rotate() -> void {
+    active.push_back(active.front());
+    active.pop_front();
+    turn = false;
+}
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
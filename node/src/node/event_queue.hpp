@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/optional/optional.hpp>
+
+#include "cocaine/detail/service/node/slave/load.hpp"
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+using slave::load_t;
+
+/// Pending events queue split into flows, which are served using deficit round-robin.
+///
+/// Each flow is identified by a key, usually the client identity, and has a weight, which is the
+/// number of events it is allowed to dequeue per round relatively to others. Events within a flow
+/// are ordered either by arrival or by deadline.
+///
+/// With a single flow the queue degrades into a plain FIFO or EDF queue.
+///
+/// \warning the class is not thread-safe.
+class event_queue_t {
+public:
+    typedef load_t::time_point time_point;
+
+private:
+    struct flow_t {
+        std::deque<load_t> loads;
+        double weight;
+        double deficit;
+    };
+
+    typedef std::unordered_map<std::string, flow_t> flows_type;
+    typedef flows_type::value_type value_type;
+
+    flows_type flows;
+
+    /// Non-empty flows in the round-robin order, the front one is being served.
+    ///
+    /// Pointers to the map nodes are stable, because rehashing doesn't invalidate them.
+    std::deque<value_type*> active;
+
+    /// Whether the front flow has already received its quantum in the current round.
+    bool turn;
+
+    std::size_t total;
+
+    /// Birthstamps of all pending events, which makes the oldest one lookup O(1) at the cost of
+    /// O(log n) bookkeeping on every push and removal.
+    std::multiset<time_point> birthstamps;
+
+public:
+    event_queue_t();
+
+    auto size() const noexcept -> std::size_t;
+    auto empty() const noexcept -> bool;
+
+    /// Pushes the load into the flow with the given key, creating it if required.
+    ///
+    /// \param weight the flow weight, must be positive.
+    /// \param edf whether to order loads within the flow by their deadline rather than arrival.
+    auto push(const std::string& key, double weight, load_t load, bool edf) -> void;
+
+    /// Returns the load to be served next.
+    ///
+    /// Calling this method multiple times without popping returns the same load.
+    ///
+    /// \pre !empty().
+    auto front() -> load_t&;
+
+    /// Removes the load returned by the last `front()` call, charging its flow.
+    ///
+    /// \pre !empty().
+    auto pop() -> void;
+
+    /// Removes the last load from the longest flow if it is longer than the flow with the given
+    /// key by more than one load.
+    ///
+    /// Used to push out the heaviest client when the queue is full, giving the room to others.
+    auto evict(const std::string& key) -> boost::optional<load_t>;
+
+    /// Removes and returns all loads which deadline is before the given time point.
+    auto expire(time_point now) -> std::vector<load_t>;
+
+    /// Returns the birthstamp of the oldest pending event.
+    auto oldest() const -> boost::optional<time_point>;
+
+private:
+    /// Drops the birthstamp of the load being removed from the queue.
+    auto forget(const load_t& load) -> void;
+
+    auto remove(value_type* flow) -> void;
+    auto rotate() -> void;
+};
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
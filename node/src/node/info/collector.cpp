@@ -45,11 +45,12 @@ info_collector_t::info_collector_t(cocaine::io::node::info::flags_t flags, dynam
     : flags(flags), result(*result) {}
 
 void
-info_collector_t::visit(std::int64_t accepted, std::int64_t rejected) const {
+info_collector_t::visit(std::int64_t accepted, std::int64_t rejected, std::int64_t expired) const {
     dynamic_t::object_t info;
 
     info["accepted"] = accepted;
     info["rejected"] = rejected;
+    info["expired"] = expired;
 
     result["requests"] = info;
 }
@@ -69,17 +70,12 @@ info_collector_t::visit(const queue_t& value) {
         value.queue_depth.add(queue.size());
         info["depth_average"] = trunc(value.queue_depth.get(), 3);
 
-        using value_type = queue_type::value_type;
-
-        if (queue.empty()) {
-            info["oldest_event_age"] = 0;
-        } else {
-            const auto min = *boost::min_element(
-                queue | boost::adaptors::transformed(+[](const value_type& cur) { return cur.event.birthstamp; }));
-
-            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - min).count();
+        if (auto oldest = queue.oldest()) {
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - *oldest).count();
 
             info["oldest_event_age"] = duration;
+        } else {
+            info["oldest_event_age"] = 0;
         }
     });
 
@@ -186,6 +182,81 @@ info_collector_t::visit(const pool_t& value) {
     });
 }
 
+void
+info_collector_t::visit(const rebalance_t& value) {
+    dynamic_t::object_t info;
+
+    info["invocations"] = value.invocations;
+    info["coalesced"] = value.coalesced;
+    info["moved"] = value.moved;
+
+    result["rebalance"] = info;
+}
+
+void
+info_collector_t::visit(const stats_t::latency_t& value) {
+    const auto phase = [&](const util::histogram_t& histogram) -> dynamic_t::object_t {
+        const auto snapshot = histogram.snapshot();
+
+        dynamic_t::object_t info;
+
+        info["count"] = snapshot.count();
+        info["50.00%"] = trunc(snapshot.value(0.5) / 1e3, 3);
+        info["90.00%"] = trunc(snapshot.value(0.9) / 1e3, 3);
+        info["99.00%"] = trunc(snapshot.value(0.99) / 1e3, 3);
+        info["99.90%"] = trunc(snapshot.value(0.999) / 1e3, 3);
+
+        return info;
+    };
+
+    dynamic_t::object_t info;
+
+    info["queue"] = phase(value.queue);
+    info["response"] = phase(value.response);
+    info["channel"] = phase(value.channel);
+
+    result["latency"] = info;
+}
+
+void
+info_collector_t::visit(const cocaine::detail::service::node::slave::transitions_t& value) {
+    typedef cocaine::detail::service::node::slave::transitions_t transitions_t;
+
+    dynamic_t::array_t recent;
+    for (const auto& record : value.recent()) {
+        dynamic_t::object_t info;
+
+        info["id"] = record.id;
+        info["from"] = record.from ? record.from : "null";
+        info["to"] = record.to;
+        info["timestamp"] = std::chrono::duration_cast<std::chrono::microseconds>(
+            record.timestamp.time_since_epoch()).count();
+        info["duration"] = trunc(record.duration.count() / 1e3, 3);
+
+        recent.emplace_back(std::move(info));
+    }
+
+    dynamic_t::object_t durations;
+    for (std::size_t state = 0; state < transitions_t::states.size(); ++state) {
+        const auto snapshot = value.duration(state).snapshot();
+
+        dynamic_t::object_t info;
+
+        info["count"] = snapshot.count();
+        info["50.00%"] = trunc(snapshot.value(0.5) / 1e3, 3);
+        info["90.00%"] = trunc(snapshot.value(0.9) / 1e3, 3);
+        info["99.00%"] = trunc(snapshot.value(0.99) / 1e3, 3);
+
+        durations[transitions_t::states[state]] = info;
+    }
+
+    dynamic_t::object_t info;
+    info["recent"] = recent;
+    info["durations"] = durations;
+
+    result["transitions"] = info;
+}
+
 template void info_collector_t::visit(metrics::timer<metrics::accumulator::decaying::exponentially_t>& timer);
 
 } // namespace info
@@ -13,6 +13,8 @@
 #include "cocaine/detail/service/node/slave.hpp"
 #include "cocaine/detail/service/node/slave/load.hpp"
 #include "cocaine/detail/service/node/stats.hpp"
+#include "node/event_queue.hpp"
+#include "node/slave/transitions.hpp"
 
 namespace cocaine {
 namespace service {
@@ -22,7 +24,7 @@ namespace info {
 using cocaine::detail::service::node::slave_t;
 using cocaine::detail::service::node::slave::load_t;
 
-typedef std::deque<load_t> queue_type;
+typedef cocaine::detail::service::node::event_queue_t queue_type;
 typedef std::unordered_map<std::string, slave_t> pool_type;
 
 // Helper tagged struct.
@@ -43,6 +45,13 @@ struct pool_t {
     const synchronized<pool_type>* pool;
 };
 
+// Helper tagged struct.
+struct rebalance_t {
+    std::int64_t invocations;
+    std::int64_t coalesced;
+    std::int64_t moved;
+};
+
 class info_collector_t {
     cocaine::io::node::info::flags_t flags;
     dynamic_t::object_t& result;
@@ -51,7 +60,7 @@ public:
     info_collector_t(cocaine::io::node::info::flags_t flags, dynamic_t::object_t* result);
 
     // Incoming requests.
-    void visit(std::int64_t accepted, std::int64_t rejected) const;
+    void visit(std::int64_t accepted, std::int64_t rejected, std::int64_t expired) const;
 
     // Pending events queue.
     void visit(const queue_t& value);
@@ -62,6 +71,15 @@ public:
     void visit(metrics::timer<Accumulate>& timer);
 
     void visit(const pool_t& value);
+
+    // Events queue rebalancing.
+    void visit(const rebalance_t& value);
+
+    // Request latency phases.
+    void visit(const stats_t::latency_t& value);
+
+    // Slave state transitions.
+    void visit(const cocaine::detail::service::node::slave::transitions_t& value);
 };
 
 } // namespace info
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <tuple>
 #include <cassert>
 #include <unordered_map>
@@ -6,7 +7,7 @@
 
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm.hpp>
-#include <boost/range/numeric.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <boost/variant.hpp>
 
 #include "engine.hpp"
@@ -34,7 +35,6 @@ namespace ph = std::placeholders;
 
 namespace conf {
     constexpr auto purgatory_queue_bound = 8 * 1024;
-    constexpr auto show_errors_limit = 3;
 
     // Number of poll iterations without worker metrics updates, used to signal
     // (post warning to log, etc,) the cases when isolate is active,
@@ -136,6 +136,16 @@ namespace detail {
         return make_counter<std::uint64_t>(ctx, cocaine::format("{}.{}", pfx, name));
     }
 
+    // Workers have only a few metrics each, so a linear scan is cheaper than hashing, besides it
+    // allows to look up by a part of the response key without allocating.
+    template<typename Map>
+    auto
+    find_slot(Map& map, const boost::string_ref& name) -> decltype(map.begin()) {
+        return std::find_if(map.begin(), map.end(), [&](const typename Map::value_type& slot) {
+            return name == boost::string_ref(slot.first);
+        });
+    }
+
     //
     // TODO: visitor should be able to process metric based on name/type,
     //       not on value type
@@ -144,10 +154,10 @@ namespace detail {
     // metrics for `should be alive` worker.
     //
     struct value_processor_t : public boost::static_visitor<int> {
-        std::string metric_name;
+        boost::string_ref metric_name;
         worker_metrics_t& victim;
 
-        value_processor_t(const std::string& metric_name, worker_metrics_t& victim) :
+        value_processor_t(const boost::string_ref& metric_name, worker_metrics_t& victim) :
             metric_name(metric_name),
             victim(victim)
         {}
@@ -156,7 +166,7 @@ namespace detail {
         auto operator()(const dynamic_t::uint_t incoming_value) -> int {
             auto& common_counters = this->victim.common_counters;
 
-            auto r = common_counters.find(this->metric_name);
+            auto r = find_slot(common_counters, this->metric_name);
             if (r == std::end(common_counters)) {
                 return 0;
             }
@@ -178,7 +188,7 @@ namespace detail {
         auto operator()(const dynamic_t::double_t value) -> int {
             auto& gauges = this->victim.gauges;
 
-            auto r = gauges.find(this->metric_name);
+            auto r = find_slot(gauges, this->metric_name);
             if (r == std::end(gauges)) {
                 return 0;
             }
@@ -280,125 +290,24 @@ operator+(worker_metrics_t& src, metrics_aggregate_proxy_t& proxy) -> metrics_ag
     return proxy + src;
 }
 
-struct response_processor_t {
-    using stats_table_type = metrics_retriever_t::stats_table_type;
-    using faded_update_mapping_type = std::unordered_map<std::string, std::chrono::seconds>;
-
-    using response_type = api::metrics_handle_base_t::response_type;
-    using metrics_mapping_type = response_type::mapped_type;
-
-    struct error_t {
-        long code;
-        std::string message;
-    };
-
-    response_processor_t(const std::string app_name) :
-        app_name(app_name)
-    {}
-
-    auto
-    operator()(context_t& ctx, const response_type& response, stats_table_type& stats_table,
-        const std::chrono::seconds& faded_timeout) -> size_t
-    {
-        return process(ctx, response, stats_table, faded_timeout);
-    }
-
-    auto
-    process(context_t& ctx, const response_type& response, stats_table_type& stats_table,
-       const std::chrono::seconds& faded_timeout) -> size_t
-    {
-        auto ids_processed = size_t{};
-
-        for(const auto& worker : response) {
-            const auto& id = worker.first;
-            const auto& metrics = worker.second;
-
-            if (id.empty()) {
-                dbg("[response] 'id' value is empty, ignoring");
-                continue;
-            }
-
-            const auto now = worker_metrics_t::clock_type::now();
-
-            auto stat_it = stats_table.find(id);
-            if (stat_it == std::end(stats_table)) {
-                // If isolate daemon sends us id we don't know about,
-                // add it to the stats (monitoring) table. If it was send by error, it
-                // would be removed from request list and from stats table
-                // on next poll iteration preparation.
-                dbg("[response] inserting new metrics record with id " << id);
-                std::tie(stat_it, std::ignore) = stats_table.emplace(id, worker_metrics_t{ctx, app_name, id});
-            }
-
-            const auto& updated_count = this->fill_metrics(metrics, stat_it->second);
-            if (updated_count) {
-                stat_it->second.update_stamp = now;
-            } else {
-                const auto& update_span = now - stat_it->second.update_stamp;
-                if (update_span > faded_timeout) {
-                    faded.emplace(id, std::chrono::duration_cast<std::chrono::seconds>(update_span));
-                }
-            }
-
-        } // for worker
-
-        return ids_processed;
-    }
-
-    auto
-    errors_count() const -> std::size_t {
-        return isolate_errors.size();
-    }
-
-    auto
-    has_errors() const -> bool {
-        return !isolate_errors.empty();
-    }
-
-    auto
-    errors() -> const std::vector<error_t>& {
-        return isolate_errors;
-    }
-
-    auto
-    has_faded() const -> bool {
-        return !faded.empty();
-    }
-
-    auto
-    faded_updates() -> const faded_update_mapping_type& {
-        return faded;
-    }
-
-private:
-
+namespace detail {
+    // Cuts off the type from the metric name.
     auto
-    parse_error_record(const metrics_mapping_type& error_record) -> void {
-        auto error_message = std::string{};
-        auto error_code = int{};
-
-        try {
-            auto it = error_record.find("what");
-            if (it != std::end(error_record)) {
-                error_message = it->second.as_string();
-            }
-
-            it = error_record.find("code");
-            if (it != std::end(error_record)) {
-                error_code = it->second.as_int();
-            }
+    decay_metric_name(const std::string& name, const char sep = '.') -> boost::string_ref {
+        const auto pos = name.find(sep);
 
-            isolate_errors.push_back(error_t{error_code, error_message});
-            dbg("[response] got an error message: " << error_message << " code: " << error_code);
-        } catch (const boost::bad_get& bg) {
-            // ignore
-            dbg("[response] error message parsing error: " << error_message << " code: " << error_code);
+        if (pos == std::string::npos) {
+            return boost::string_ref(name);
         }
+
+        return boost::string_ref(name.data(), pos);
     }
 
     auto
-    fill_metrics(const metrics_mapping_type& metrics, worker_metrics_t& result) -> size_t {
-        auto updated = size_t{};
+    fill_metrics(const metrics_retriever_t::metrics_mapping_type& metrics, worker_metrics_t& result)
+        -> std::size_t
+    {
+        auto updated = std::size_t{};
 
         for(const auto& metric : metrics) {
             const auto& name = metric.first;
@@ -406,9 +315,8 @@ private:
 
             dbg("[response] metrics name: " << name);
 
-            std::string nm;
             // type not checked (for now)
-            std::tie(nm, std::ignore) = decay_metric_name(name);
+            const auto nm = decay_metric_name(name);
 
             if (nm.empty()) {
                 // protocol error: ingore silently
@@ -418,7 +326,7 @@ private:
 
             try {
                 dbg("[response] found metrics record for " << nm << ", updating...");
-                auto processor = detail::value_processor_t(nm, result);
+                auto processor = value_processor_t(nm, result);
                 updated += value.apply(processor);
             } catch (const std::exception& err) {
                 // TODO: report to log
@@ -430,32 +338,7 @@ private:
         dbg("[response] fill_metrics done");
         return updated;
     }
-
-private:
-
-    auto
-    decay_metric_name(const std::string& name, const char sep='.') -> std::tuple<std::string, std::string> {
-        // cut off type from name
-        const auto pos = name.find(sep);
-
-        if (pos == std::string::npos) {
-            return std::make_tuple(name, "");
-        }
-
-        const auto nm = name.substr(0, pos);
-        const auto tp = name.substr(pos + 1);
-
-        return std::make_tuple(nm, tp);
-    }
-
-    std::string app_name;
-    std::vector<error_t> isolate_errors;
-
-    // Table of workers uuids (and their update time stamps) which wasn't
-    // updated for poll_interval * missed_updates_times period of time.
-    // Used to signal (post to log) a warning.
-    faded_update_mapping_type faded;
-};
+}
 
 worker_metrics_t::worker_metrics_t(context_t& ctx, const std::string& name_prefix) :
     ctx(ctx),
@@ -583,197 +466,386 @@ worker_metrics_t::update_gauge(const std::string& name, Fn&& fun) -> void
     }
 }
 
-metrics_retriever_t::self_metrics_t::self_metrics_t(context_t& ctx, const std::string& pfx) :
-   uuids_requested{detail::make_uint_counter(ctx, pfx, "uuids.requested")},
-   uuids_recieved{detail::make_uint_counter(ctx, pfx, "uuids.recieved")},
-   requests_send{detail::make_uint_counter(ctx, pfx, "requests")},
-   empty_requests{detail::make_uint_counter(ctx, pfx, "empty.requests")},
-   responses_received{detail::make_uint_counter(ctx, pfx, "responses")},
-   receive_errors{detail::make_uint_counter(ctx, pfx, "recieve.errors")},
-   posmortem_queue_size{detail::make_uint_counter(ctx, pfx, "postmortem.queue.size")}
-{}
+//// metrics_retriever_t /////////////////////////////////////////////////////
 
 metrics_retriever_t::metrics_retriever_t(
     context_t& ctx,
     const std::string& name, // app name
     std::shared_ptr<api::isolate_t> isolate,
+    std::string isolate_key,
     const std::shared_ptr<engine_t>& engine,
-    asio::io_service& loop,
-    const std::uint64_t poll_interval) :
+    std::chrono::seconds poll_interval) :
         context(ctx),
-        metrics_poll_timer(loop),
-        isolate(std::move(isolate)),
+        isolate_(std::move(isolate)),
+        isolate_key_(std::move(isolate_key)),
         parent_engine(engine),
         log(ctx.log(format("{}/workers_metrics", name))),
-        self_metrics(ctx, "node.isolate.poll.metrics"),
+        postmortem_queue_size(detail::make_uint_counter(ctx, "node.isolate.poll.metrics", "postmortem.queue.size")),
         app_name(name),
-        poll_interval(poll_interval),
+        faded_timeout(poll_interval * conf::missed_updates_times),
         app_aggregate_metrics(ctx, cocaine::format("{}.isolate", name))
 {
     COCAINE_LOG_INFO(log, "worker metrics retriever has been initialized");
 }
 
 auto
-metrics_retriever_t::ignite_poll() -> void {
-    metrics_poll_timer.expires_from_now(poll_interval);
-    metrics_poll_timer.async_wait(std::bind(&metrics_retriever_t::poll_metrics, shared_from_this(), ph::_1));
+metrics_retriever_t::isolate() const -> const std::shared_ptr<api::isolate_t>& {
+    return isolate_;
 }
 
 auto
-metrics_retriever_t::add_post_mortem(const std::string& id) -> void {
-    if (purgatory->size() >= conf::purgatory_queue_bound) {
-        // on high despawn rates stat of some unlucky workers will be lost
-        COCAINE_LOG_INFO(log, "worker metrics retriever: dead worker stat will be discarded for {}", id);
-        return;
-    }
+metrics_retriever_t::isolate_key() const -> const std::string& {
+    return isolate_key_;
+}
 
+auto
+metrics_retriever_t::add_post_mortem(const std::string& id) -> void {
     purgatory.apply([&](purgatory_pot_type& pot) {
-        pot.emplace(id);
-        self_metrics.posmortem_queue_size->store(pot.size());
+        if (pot.size() >= conf::purgatory_queue_bound) {
+            // on high despawn rates stat of some unlucky workers will be lost
+            COCAINE_LOG_INFO(log, "worker metrics retriever: dead worker stat will be discarded for {}", id);
+            return;
+        }
+
+        if (pot.emplace(id).second) {
+            postmortem_queue_size->fetch_add(1);
+        }
     });
 }
 
 auto
-metrics_retriever_t::poll_metrics(const std::error_code& ec) -> void {
-    if (ec) {
-        // cancelled
-        COCAINE_LOG_WARNING(log, "workers metrics polling was cancelled");
-        return;
-    }
-
+metrics_retriever_t::collect(std::vector<std::string>& query) -> bool {
     std::shared_ptr<engine_t> parent = parent_engine.lock();
     if (!parent) {
-        return;
-    }
-
-    if (!isolate) {
-        ignite_poll();
-        return;
+        return false;
     }
 
     auto alive_uuids = parent->pooled_workers_ids();
 
     DBG_DUMP_UUIDS(std::cerr, "metrics.of_pool", alive_uuids);
 
-#ifdef ISOMETRICS_DEBUG
-    purgatory.apply([&](const purgatory_pot_type& pot) {
-        DBG_DUMP_UUIDS(std::cerr, "purgatory", pot);
-    });
-#endif
-
-    std::vector<std::string> query;
-    query.reserve(alive_uuids.size() + purgatory->size());
-
     // Note: it is promised by devs that active list should be quite
     // small ~ hundreds of workers, so it seems reasonable to pay a little for
     // sorting here, but code should be redesigned if average alive count
     // will increase significantly
     boost::sort(alive_uuids);
 
+    const auto offset = query.size();
+
     purgatory.apply([&](purgatory_pot_type& pot) {
+        DBG_DUMP_UUIDS(std::cerr, "purgatory", pot);
+
         boost::set_union(alive_uuids, pot, std::back_inserter(query));
+        postmortem_queue_size->fetch_sub(pot.size());
         pot.clear();
-        self_metrics.posmortem_queue_size->store(0);
     });
 
-#if 0
-    query.emplace_back("DEADBEEF-0001-0001-0001-000000000001");
-    query.emplace_back("C0C0C042-0042-0042-0042-000000000042");
-#endif
+    const auto begin = query.begin() + static_cast<std::ptrdiff_t>(offset);
 
-    DBG_DUMP_UUIDS(std::cerr, "query array", query);
+    // At this point we have gathered uuids of available (alived, pooled) workers and dead
+    // recently workers, so stat table can be cleared out of garbage `neither alive nor dead`
+    // uuids in place.
+    metrics.apply([&](stats_table_type& table) {
+        for (auto it = table.begin(); it != table.end();) {
+            if (std::binary_search(begin, query.end(), it->first)) {
+                ++it;
+            } else {
+                it = table.erase(it);
+            }
+        }
+    });
 
-    // TODO: should we send empty query as some kind of heartbeat?
-    if (query.empty()) {
-        self_metrics.empty_requests->fetch_add(1);
-    }
+    return true;
+}
 
-    isolate->metrics(query, std::make_shared<metrics_handle_t>(shared_from_this()));
-    self_metrics.requests_send->fetch_add(1);
+auto
+metrics_retriever_t::apply(const std::string& id, const metrics_mapping_type& values,
+                           worker_metrics_t::clock_type::time_point now) -> bool
+{
+    return metrics.apply([&](stats_table_type& table) {
+        auto stat_it = table.find(id);
+        if (stat_it == std::end(table)) {
+            // Worker metrics are registered only once, all following updates are stored into
+            // the same slots.
+            dbg("[response] inserting new metrics record with id " << id);
+            std::tie(stat_it, std::ignore) = table.emplace(id, worker_metrics_t{context, app_name, id});
+        }
 
-    // At this point query is posted and we have gathered uuids of available
-    // (alived, pooled) workers and dead recently workers, so we can clear
-    // stat_table out of garbage `neither alive nor dead` uuids
-    stats_table_type preserved_metrics;
-    preserved_metrics.reserve(metrics->size());
+        auto& record = stat_it->second;
 
-    metrics.apply([&](stats_table_type& table) {
-        for(const auto& to_preserve : query) {
-            const auto it = table.find(to_preserve);
+        if (detail::fill_metrics(values, record)) {
+            record.update_stamp = now;
+            return true;
+        }
 
-            if (it != std::end(table)) {
-                preserved_metrics.emplace(std::move(*it));
-            }
+        const auto update_span = now - record.update_stamp;
+        if (update_span > faded_timeout) {
+            COCAINE_LOG_WARNING(log, "no isolate metrics for active worker {} for {} second(s)", id,
+                std::chrono::duration_cast<std::chrono::seconds>(update_span).count());
         }
 
-        table.clear();
-        table.swap(preserved_metrics);
+        return false;
     });
+}
 
-    // Update self stat
-    self_metrics.uuids_requested->fetch_add(query.size());
+auto
+metrics_retriever_t::commit() -> void {
+    metrics.apply([&](const stats_table_type& table) {
+        metrics_aggregate_proxy_t proxy;
 
-    ignite_poll();
+        for (const auto& worker : table) {
+            proxy + worker.second;
+        }
+
+        // update application-wide aggregate of metrics
+        app_aggregate_metrics.assign(std::move(proxy));
+    });
+}
+
+auto
+metrics_retriever_t::memory_usage() -> std::unordered_map<std::string, std::uint64_t> {
+    std::unordered_map<std::string, std::uint64_t> usage;
+
+    metrics.apply([&](const stats_table_type& table) {
+        for (const auto& worker : table) {
+            const auto it = worker.second.common_counters.find("mem");
+            if (it != std::end(worker.second.common_counters)) {
+                usage.emplace(worker.first, it->second.value->load());
+            }
+        }
+    });
+
+    return usage;
 }
 
 auto
 metrics_retriever_t::make_observer() -> std::shared_ptr<pool_observer> {
-    return std::make_shared<metrics_pool_observer_t>(*this);
+    return std::make_shared<metrics_pool_observer_t>(shared_from_this());
 }
 
-//// metrics_handle_t //////////////////////////////////////////////////////////
+//// metrics_poller_t //////////////////////////////////////////////////////////
+
+/// Single request to an isolation daemon on behalf of several applications.
+struct metrics_poller_t::batch_t {
+    std::vector<std::string> query;
+    std::vector<std::shared_ptr<metrics_retriever_t>> retrievers;
+
+    /// Index of the owning retriever for each query entry.
+    std::vector<std::size_t> owners;
+
+    /// Query positions ordered by uuid.
+    std::vector<std::size_t> order;
+
+    auto
+    add(const std::shared_ptr<metrics_retriever_t>& retriever) -> void {
+        const auto offset = query.size();
+
+        if (!retriever->collect(query)) {
+            return;
+        }
+
+        owners.resize(query.size(), retrievers.size());
+        retrievers.push_back(retriever);
+
+        for (auto id = offset; id < query.size(); ++id) {
+            order.push_back(id);
+        }
+    }
+
+    auto
+    seal() -> void {
+        std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+            return query[lhs] < query[rhs];
+        });
+    }
+
+    auto
+    owner(const std::string& id) const -> metrics_retriever_t* {
+        const auto it = std::lower_bound(order.begin(), order.end(), id,
+            [&](std::size_t position, const std::string& id) {
+                return query[position] < id;
+            }
+        );
+
+        if (it == order.end() || query[*it] != id) {
+            return nullptr;
+        }
+
+        return retrievers[owners[*it]].get();
+    }
+};
+
+metrics_poller_t::self_metrics_t::self_metrics_t(context_t& ctx, const std::string& pfx) :
+   uuids_requested{detail::make_uint_counter(ctx, pfx, "uuids.requested")},
+   uuids_recieved{detail::make_uint_counter(ctx, pfx, "uuids.recieved")},
+   requests_send{detail::make_uint_counter(ctx, pfx, "requests")},
+   empty_requests{detail::make_uint_counter(ctx, pfx, "empty.requests")},
+   responses_received{detail::make_uint_counter(ctx, pfx, "responses")},
+   receive_errors{detail::make_uint_counter(ctx, pfx, "recieve.errors")}
+{}
+
+metrics_poller_t::metrics_poller_t(context_t& ctx, asio::io_service& loop, std::uint64_t poll_interval) :
+    context(ctx),
+    log(ctx.log("node/workers_metrics")),
+    metrics_poll_timer(loop),
+    poll_interval(static_cast<long>(poll_interval)),
+    self_metrics(ctx, "node.isolate.poll.metrics")
+{
+    COCAINE_LOG_INFO(log, "worker metrics poller has been initialized");
+}
 
 auto
-metrics_retriever_t::metrics_handle_t::on_data(const response_type& data) -> void {
-    using namespace boost::adaptors;
+metrics_poller_t::make(context_t& ctx, asio::io_service& loop, const dynamic_t& args)
+    -> std::shared_ptr<metrics_poller_t>
+{
+    const auto& object = args.as_object();
 
-    assert(parent);
+    if (!object.at("isolate_metrics", false).as_bool()) {
+        return nullptr;
+    }
 
-    dbg("metrics_handle_t::on_data");
-    COCAINE_LOG_DEBUG(parent->log, "processing isolation metrics response");
+    auto poller = std::make_shared<metrics_poller_t>(
+        ctx,
+        loop,
+        object.at("isolate_metrics_poll_period_s", conf::metrics_poll_interval_s).as_uint());
 
-    const auto faded_timeout = std::chrono::seconds(parent->poll_interval.total_seconds() * conf::missed_updates_times);
-    response_processor_t processor(parent->app_name);
+    poller->ignite_poll();
 
-    // should not harm performance, as this handler would be called from same
-    // poll loop, within same thread on each poll iteration
-    const auto processed_count = parent->metrics.apply([&](metrics_retriever_t::stats_table_type& table) {
+    return poller;
+}
 
-        // fill workers current `slice` state of metrics table
-        const auto processed_count = processor(parent->context, data, table, faded_timeout);
+auto
+metrics_poller_t::interval() const -> std::chrono::seconds {
+    return std::chrono::seconds(poll_interval.total_seconds());
+}
 
-        // update application-wide aggregate of metrics
-        parent->app_aggregate_metrics.assign(
-            boost::accumulate( table | map_values, metrics_aggregate_proxy_t()));
+auto
+metrics_poller_t::attach(std::shared_ptr<metrics_retriever_t> retriever) -> void {
+    retrievers->push_back(std::move(retriever));
+}
 
-        return processed_count;
-    });
+auto
+metrics_poller_t::ignite_poll() -> void {
+    metrics_poll_timer.expires_from_now(poll_interval);
+    metrics_poll_timer.async_wait(std::bind(&metrics_poller_t::poll_metrics, shared_from_this(), ph::_1));
+}
 
-    parent->self_metrics.uuids_recieved->fetch_add(processed_count);
-    parent->self_metrics.responses_received->fetch_add(1);
+auto
+metrics_poller_t::cancel() -> void {
+    metrics_poll_timer.cancel();
+}
 
-    if (processor.has_errors()) {
-        const auto& errors = processor.errors();
-        auto break_counter = int{};
+auto
+metrics_poller_t::poll_metrics(const std::error_code& ec) -> void {
+    if (ec) {
+        // cancelled
+        COCAINE_LOG_WARNING(log, "workers metrics polling was cancelled");
+        return;
+    }
 
-        for(const auto& e : errors) {
-            if (++break_counter > conf::show_errors_limit) {
-                break;
+    std::vector<std::shared_ptr<metrics_retriever_t>> alive;
+
+    retrievers.apply([&](std::vector<std::weak_ptr<metrics_retriever_t>>& retrievers) {
+        alive.reserve(retrievers.size());
+
+        for (auto it = retrievers.begin(); it != retrievers.end();) {
+            if (auto retriever = it->lock()) {
+                alive.push_back(std::move(retriever));
+                ++it;
+            } else {
+                it = retrievers.erase(it);
             }
-            COCAINE_LOG_DEBUG(parent->log, "isolation metrics got an error {} {}", e.code, e.message);
         }
+    });
+
+    // Applications sharing the same isolation daemon are polled with a single request.
+    std::stable_sort(alive.begin(), alive.end(),
+        [](const std::shared_ptr<metrics_retriever_t>& lhs, const std::shared_ptr<metrics_retriever_t>& rhs) {
+            return lhs->isolate_key() < rhs->isolate_key();
+        }
+    );
+
+    for (auto it = alive.begin(); it != alive.end();) {
+        const auto& key = (*it)->isolate_key();
+        const auto end = std::find_if(it, alive.end(), [&](const std::shared_ptr<metrics_retriever_t>& retriever) {
+            return retriever->isolate_key() != key;
+        });
+
+        auto batch = std::make_shared<batch_t>();
+        for (; it != end; ++it) {
+            batch->add(*it);
+        }
+
+        if (batch->retrievers.empty()) {
+            continue;
+        }
+
+        batch->seal();
+
+        DBG_DUMP_UUIDS(std::cerr, "query array", batch->query);
+
+        // TODO: should we send empty query as some kind of heartbeat?
+        if (batch->query.empty()) {
+            self_metrics.empty_requests->fetch_add(1);
+        }
+
+        const auto isolate = batch->retrievers.front()->isolate();
+        if (!isolate) {
+            continue;
+        }
+
+        isolate->metrics(batch->query, std::make_shared<metrics_handle_t>(shared_from_this(), batch));
+
+        // Update self stat
+        self_metrics.requests_send->fetch_add(1);
+        self_metrics.uuids_requested->fetch_add(batch->query.size());
     }
 
-    for(const auto& faded : processor.faded_updates()) {
-        const auto& id = faded.first;
-        const auto& duration = faded.second;
+    ignite_poll();
+}
+
+//// metrics_handle_t //////////////////////////////////////////////////////////
 
-        COCAINE_LOG_WARNING(parent->log, "no isolate metrics for active worker {} for {} second(s)", id, duration.count());
+auto
+metrics_poller_t::metrics_handle_t::on_data(const response_type& data) -> void {
+    assert(parent);
+    assert(batch);
+
+    dbg("metrics_handle_t::on_data");
+    COCAINE_LOG_DEBUG(parent->log, "processing isolation metrics response");
+
+    const auto now = worker_metrics_t::clock_type::now();
+    auto processed_count = std::size_t{};
+
+    for(const auto& worker : data) {
+        const auto& id = worker.first;
+
+        if (id.empty()) {
+            dbg("[response] 'id' value is empty, ignoring");
+            continue;
+        }
+
+        // Uuids which weren't requested would be dropped on the next poll iteration anyway.
+        auto retriever = batch->owner(id);
+        if (retriever == nullptr) {
+            continue;
+        }
+
+        if (retriever->apply(id, worker.second, now)) {
+            ++processed_count;
+        }
+    }
+
+    for (const auto& retriever : batch->retrievers) {
+        retriever->commit();
     }
+
+    parent->self_metrics.uuids_recieved->fetch_add(processed_count);
+    parent->self_metrics.responses_received->fetch_add(1);
 }
 
 auto
-metrics_retriever_t::metrics_handle_t::on_error(const std::error_code& error, const std::string& what) -> void {
+metrics_poller_t::metrics_handle_t::on_error(const std::error_code& error, const std::string& what) -> void {
     assert(parent);
     dbg("metrics_handle_t::on_error: " << what);
 
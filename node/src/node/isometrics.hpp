@@ -2,7 +2,9 @@
 
 #include <chrono>
 #include <memory>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 #include <blackhole/logger.hpp>
 #include <blackhole/scope/holder.hpp>
@@ -125,21 +127,26 @@ struct metrics_aggregate_proxy_t {
     operator+(const worker_metrics_t& worker_metrics) -> metrics_aggregate_proxy_t&;
 };
 
-/// Isolation daemon's workers metrics sampler.
+/// Per-application isolation daemon's workers metrics table.
 ///
-/// Poll sequence should be initialized explicitly with
-/// metrics_retriever_t::ignite_poll method or implicitly
-/// within metrics_retriever_t::make_and_ignite.
+/// Doesn't poll the isolate itself, instead it is attached to the node-wide `metrics_poller_t`,
+/// which batches queries of all applications into a single request.
 class metrics_retriever_t :
     public std::enable_shared_from_this<metrics_retriever_t>
 {
 public:
     using stats_table_type = std::unordered_map<std::string, worker_metrics_t>;
+    using response_type = api::metrics_handle_base_t::response_type;
+    using metrics_mapping_type = response_type::mapped_type;
+
 private:
     context_t& context;
 
-    asio::deadline_timer metrics_poll_timer;
-    std::shared_ptr<api::isolate_t> isolate;
+    std::shared_ptr<api::isolate_t> isolate_;
+
+    // Applications with equal keys are served by the same isolation daemon, hence could be
+    // polled with a single request.
+    std::string isolate_key_;
 
     std::weak_ptr<engine_t> parent_engine;
 
@@ -155,63 +162,34 @@ private:
     using purgatory_pot_type = std::set<std::string>;
     synchronized<purgatory_pot_type> purgatory;
 
-    // `synchronized` not needed within current design, but shouldn't do any harm
+    // Node-wide, shared between all applications.
+    metrics::shared_metric<std::atomic<std::uint64_t>> postmortem_queue_size;
+
+    // Updated from the poller's loop, read on aggregation.
     // <uuid, metrics>
     synchronized<stats_table_type> metrics;
 
-    struct self_metrics_t {
-        metrics::shared_metric<std::atomic<std::uint64_t>> uuids_requested;
-        metrics::shared_metric<std::atomic<std::uint64_t>> uuids_recieved;
-        metrics::shared_metric<std::atomic<std::uint64_t>> requests_send;
-        metrics::shared_metric<std::atomic<std::uint64_t>> empty_requests;
-        metrics::shared_metric<std::atomic<std::uint64_t>> responses_received;
-        metrics::shared_metric<std::atomic<std::uint64_t>> receive_errors;
-        metrics::shared_metric<std::atomic<std::uint64_t>> posmortem_queue_size;
-        self_metrics_t(context_t& ctx, const std::string& name);
-    } self_metrics;
-
     std::string app_name;
-    boost::posix_time::seconds poll_interval;
+
+    // Workers without metrics updates for that long are reported to log.
+    std::chrono::seconds faded_timeout;
 
     worker_metrics_t app_aggregate_metrics;
-public:
 
+public:
     metrics_retriever_t(
         context_t& ctx,
         const std::string& name,
         std::shared_ptr<api::isolate_t> isolate,
+        std::string isolate_key,
         const std::shared_ptr<engine_t>& parent_engine,
-        asio::io_service& loop,
-        const std::uint64_t poll_interval);
+        std::chrono::seconds poll_interval);
 
-    ///
-    /// Reads following section from Cocaine-RT configuration:
-    ///  ```
-    ///  "node" : {
-    ///     ...
-    ///     "args" : {
-    ///        "isolate_metrics:" : true,
-    ///        "isolate_metrics_poll_period_s" : 10
-    ///     }
-    ///  }
-    ///  ```
-    /// if `isolate_metrics` is false (default), returns nullptr,
-    /// and polling sequence wouldn't start.
-    ///
-    // TODO: it seems that throw on construction error would be a better choice.
-    template<typename Observers>
-    static
     auto
-    make_and_ignite(
-        context_t& ctx,
-        const std::string& name,
-        std::shared_ptr<api::isolate_t> isolate,
-        const std::shared_ptr<engine_t>& parent_engine,
-        asio::io_service& loop,
-        synchronized<Observers>& observers) -> std::shared_ptr<metrics_retriever_t>;
+    isolate() const -> const std::shared_ptr<api::isolate_t>&;
 
     auto
-    ignite_poll() -> void;
+    isolate_key() const -> const std::string&;
 
     auto
     make_observer() -> std::shared_ptr<cocaine::service::node::pool_observer>;
@@ -228,36 +206,33 @@ public:
     auto
     add_post_mortem(const std::string& id) -> void;
 
-private:
-
+    /// Appends sorted uuids of both pooled and recently despawned workers to the query, dropping
+    /// metrics of workers which are neither.
+    ///
+    /// Returns false if the parent engine has already gone.
     auto
-    poll_metrics(const std::error_code& ec) -> void;
+    collect(std::vector<std::string>& query) -> bool;
 
-private:
-
-    // TODO: wip, possibility of redesign
-    struct metrics_handle_t : public api::metrics_handle_base_t
-    {
-        using response_type = api::metrics_handle_base_t::response_type;
-
-        metrics_handle_t(std::shared_ptr<metrics_retriever_t> parent) :
-            parent{parent}
-        {}
-
-        auto
-        on_data(const response_type& data) -> void override;
+    /// Updates metrics of a single worker from the isolate response.
+    ///
+    /// Returns true if at least one metric has been updated.
+    auto
+    apply(const std::string& id, const metrics_mapping_type& metrics,
+          worker_metrics_t::clock_type::time_point now) -> bool;
 
-        auto
-        on_error(const std::error_code&, const std::string& what) -> void override;
+    /// Updates application-wide aggregate after all workers of the response have been applied.
+    auto
+    commit() -> void;
 
-        std::shared_ptr<metrics_retriever_t> parent;
-    };
+    /// Returns the last reported memory usage in bytes of each worker, which has any.
+    auto
+    memory_usage() -> std::unordered_map<std::string, std::uint64_t>;
 
-    // TODO: wip, possibility of redesign
+private:
     struct metrics_pool_observer_t : public cocaine::service::node::pool_observer {
 
-        metrics_pool_observer_t(metrics_retriever_t& p) :
-            parent(p)
+        metrics_pool_observer_t(std::weak_ptr<metrics_retriever_t> p) :
+            parent(std::move(p))
         {}
 
         auto
@@ -266,58 +241,103 @@ private:
 
         auto
         despawned(const std::string& id) -> void override {
-            parent.add_post_mortem(id);
+            if (auto retriever = parent.lock()) {
+                retriever->add_post_mortem(id);
+            }
         }
 
     private:
-        metrics_retriever_t& parent;
+        std::weak_ptr<metrics_retriever_t> parent;
     };
 
 }; // metrics_retriever_t
 
-template<typename Observers>
-auto
-metrics_retriever_t::make_and_ignite(
-    context_t& ctx,
-    const std::string& name,
-    std::shared_ptr<api::isolate_t> isolate,
-    const std::shared_ptr<engine_t>& parent_engine,
-    asio::io_service& loop,
-    synchronized<Observers>& observers) -> std::shared_ptr<metrics_retriever_t>
+/// Node-wide isolation daemon's workers metrics sampler.
+///
+/// Every poll interval collects worker uuids of all attached applications, sends a single
+/// `metrics` request per isolation daemon and routes the response back to the owning
+/// applications' tables.
+class metrics_poller_t :
+    public std::enable_shared_from_this<metrics_poller_t>
 {
-    if (!isolate) {
-        throw error_t(cocaine::error::component_not_registered, "isolate daemon object wasn't provided");
-    }
+    context_t& context;
 
-    // TODO: node service can be set with another name
-    const auto node_config = ctx.config().component_group("services").get("node");
+    const std::unique_ptr<cocaine::logging::logger_t> log;
 
-    if (node_config) {
-        const auto args = node_config->args().as_object();
+    asio::deadline_timer metrics_poll_timer;
+    boost::posix_time::seconds poll_interval;
 
-        const auto& should_start = args.at("isolate_metrics", false).as_bool();
-        const auto& poll_interval = args.at("isolate_metrics_poll_period_s", conf::metrics_poll_interval_s).as_uint();
+    synchronized<std::vector<std::weak_ptr<metrics_retriever_t>>> retrievers;
 
-        if (!should_start) {
-            throw error_t(cocaine::error::component_not_registered, "'isolate_metrics' wasn't set in config");
-        }
+    struct self_metrics_t {
+        metrics::shared_metric<std::atomic<std::uint64_t>> uuids_requested;
+        metrics::shared_metric<std::atomic<std::uint64_t>> uuids_recieved;
+        metrics::shared_metric<std::atomic<std::uint64_t>> requests_send;
+        metrics::shared_metric<std::atomic<std::uint64_t>> empty_requests;
+        metrics::shared_metric<std::atomic<std::uint64_t>> responses_received;
+        metrics::shared_metric<std::atomic<std::uint64_t>> receive_errors;
+        self_metrics_t(context_t& ctx, const std::string& name);
+    } self_metrics;
+
+public:
+    metrics_poller_t(context_t& ctx, asio::io_service& loop, std::uint64_t poll_interval);
+
+    ///
+    /// Reads following section from the node service arguments:
+    ///  ```
+    ///  "node" : {
+    ///     ...
+    ///     "args" : {
+    ///        "isolate_metrics:" : true,
+    ///        "isolate_metrics_poll_period_s" : 10
+    ///     }
+    ///  }
+    ///  ```
+    /// if `isolate_metrics` is false (default), returns nullptr,
+    /// and polling sequence wouldn't start.
+    ///
+    static
+    auto
+    make(context_t& ctx, asio::io_service& loop, const dynamic_t& args)
+        -> std::shared_ptr<metrics_poller_t>;
 
-        auto retriever = std::make_shared<metrics_retriever_t>(
-            ctx,
-            name,
-            std::move(isolate),
-            parent_engine,
-            loop,
-            poll_interval);
+    auto
+    interval() const -> std::chrono::seconds;
 
-        observers->emplace_back(retriever->make_observer());
-        retriever->ignite_poll();
+    auto
+    attach(std::shared_ptr<metrics_retriever_t> retriever) -> void;
 
-        return retriever;
-    }
+    auto
+    ignite_poll() -> void;
 
-    throw error_t(cocaine::error::component_not_found, "node server config section wasn't found");
-}
+    auto
+    cancel() -> void;
+
+private:
+    auto
+    poll_metrics(const std::error_code& ec) -> void;
+
+    struct batch_t;
+
+    struct metrics_handle_t : public api::metrics_handle_base_t
+    {
+        using response_type = api::metrics_handle_base_t::response_type;
+
+        metrics_handle_t(std::shared_ptr<metrics_poller_t> parent, std::shared_ptr<batch_t> batch) :
+            parent(std::move(parent)),
+            batch(std::move(batch))
+        {}
+
+        auto
+        on_data(const response_type& data) -> void override;
+
+        auto
+        on_error(const std::error_code&, const std::string& what) -> void override;
+
+        std::shared_ptr<metrics_poller_t> parent;
+        std::shared_ptr<batch_t> batch;
+    };
+}; // metrics_poller_t
 
 }  // namespace node
 }  // namespace service
@@ -0,0 +1,161 @@
+#include "load_index.hpp"
+
+#include <utility>
+
+#include <boost/assert.hpp>
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+load_index_t::load_index_t() :
+    total(0)
+{}
+
+auto load_index_t::insert(const std::string& id) -> void {
+    entries.insert(std::make_pair(id, entry_t{0, false, 0}));
+}
+
+auto load_index_t::erase(const std::string& id) -> void {
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return;
+    }
+
+    if (it->second.active) {
+        remove(*it);
+    }
+
+    total -= it->second.load;
+    entries.erase(it);
+}
+
+auto load_index_t::clear() -> void {
+    heap.clear();
+    entries.clear();
+    total = 0;
+}
+
+auto load_index_t::load(const std::string& id, std::uint64_t load) -> void {
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return;
+    }
+
+    auto& entry = it->second;
+    const auto prev = entry.load;
+
+    total = total - prev + load;
+    entry.load = load;
+
+    if (entry.active) {
+        if (load < prev) {
+            sift_up(entry.position);
+        } else {
+            sift_down(entry.position);
+        }
+    }
+}
+
+auto load_index_t::activity(const std::string& id, bool active) -> void {
+    auto it = entries.find(id);
+    if (it == entries.end() || it->second.active == active) {
+        return;
+    }
+
+    if (active) {
+        push(*it);
+    } else {
+        remove(*it);
+    }
+}
+
+auto load_index_t::select(std::uint64_t limit) const -> const std::string* {
+    if (heap.empty() || heap.front()->second.load >= limit) {
+        return nullptr;
+    }
+
+    return &heap.front()->first;
+}
+
+auto load_index_t::pressure() const noexcept -> std::uint64_t {
+    return total;
+}
+
+auto load_index_t::active() const noexcept -> std::size_t {
+    return heap.size();
+}
+
+auto load_index_t::push(value_type& value) -> void {
+    value.second.active = true;
+    value.second.position = heap.size();
+    heap.push_back(&value);
+    sift_up(value.second.position);
+}
+
+auto load_index_t::remove(value_type& value) -> void {
+    BOOST_ASSERT(value.second.active);
+
+    const auto position = value.second.position;
+    const auto last = heap.size() - 1;
+
+    value.second.active = false;
+
+    if (position != last) {
+        swap(position, last);
+        heap.pop_back();
+        sift_down(position);
+        sift_up(position);
+    } else {
+        heap.pop_back();
+    }
+}
+
+auto load_index_t::sift_up(std::size_t position) -> void {
+    while (position > 0) {
+        const auto parent = (position - 1) / 2;
+        if (heap[parent]->second.load <= heap[position]->second.load) {
+            break;
+        }
+
+        swap(parent, position);
+        position = parent;
+    }
+}
+
+auto load_index_t::sift_down(std::size_t position) -> void {
+    const auto size = heap.size();
+
+    while (true) {
+        const auto lhs = 2 * position + 1;
+        const auto rhs = lhs + 1;
+
+        auto min = position;
+        if (lhs < size && heap[lhs]->second.load < heap[min]->second.load) {
+            min = lhs;
+        }
+
+        if (rhs < size && heap[rhs]->second.load < heap[min]->second.load) {
+            min = rhs;
+        }
+
+        if (min == position) {
+            break;
+        }
+
+        swap(min, position);
+        position = min;
+    }
+}
+
+auto load_index_t::swap(std::size_t lhs, std::size_t rhs) -> void {
+    std::swap(heap[lhs], heap[rhs]);
+    heap[lhs]->second.position = lhs;
+    heap[rhs]->second.position = rhs;
+}
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
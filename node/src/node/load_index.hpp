@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+/// Slaves index ordered by their load.
+///
+/// Tracks the load of every slave in the pool and keeps active ones in an indexed binary min-heap,
+/// which makes load updates O(log n), while both the least loaded slave lookup and the total pool
+/// pressure are O(1).
+///
+/// \warning the class is not thread-safe.
+class load_index_t {
+    struct entry_t {
+        std::uint64_t load;
+        bool active;
+
+        /// Position in the heap, meaningful only for active slaves.
+        std::size_t position;
+    };
+
+    typedef std::unordered_map<std::string, entry_t> entries_type;
+    typedef entries_type::value_type value_type;
+
+    entries_type entries;
+
+    /// Active slaves ordered as a binary min-heap by their load.
+    ///
+    /// Pointers to the map nodes are stable, because rehashing doesn't invalidate them.
+    std::vector<value_type*> heap;
+
+    /// Cumulative load over all slaves, including inactive ones.
+    std::uint64_t total;
+
+public:
+    load_index_t();
+
+    /// Starts tracking a new inactive slave with no load.
+    auto insert(const std::string& id) -> void;
+
+    auto erase(const std::string& id) -> void;
+
+    auto clear() -> void;
+
+    /// Updates the load of the given slave.
+    ///
+    /// Does nothing if the slave is not tracked, i.e. has been already removed from the pool.
+    auto load(const std::string& id, std::uint64_t load) -> void;
+
+    /// Updates the activity of the given slave, only active slaves can be selected.
+    ///
+    /// Does nothing if the slave is not tracked, i.e. has been already removed from the pool.
+    auto activity(const std::string& id, bool active) -> void;
+
+    /// Returns the id of the least loaded active slave if its load is less than the given limit.
+    ///
+    /// The returned pointer remains valid until the slave is erased from the index.
+    auto select(std::uint64_t limit) const -> const std::string*;
+
+    /// Returns the cumulative load over all tracked slaves.
+    auto pressure() const noexcept -> std::uint64_t;
+
+    /// Returns the number of active slaves.
+    auto active() const noexcept -> std::size_t;
+
+private:
+    auto push(value_type& value) -> void;
+    auto remove(value_type& value) -> void;
+
+    auto sift_up(std::size_t position) -> void;
+    auto sift_down(std::size_t position) -> void;
+    auto swap(std::size_t lhs, std::size_t rhs) -> void;
+};
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
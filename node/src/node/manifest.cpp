@@ -30,7 +30,11 @@
 using namespace cocaine;
 
 manifest_t::manifest_t(context_t& context, const std::string& name_):
-    cached<dynamic_t>(context, "manifests", name_),
+    manifest_t(context, name_, cached<dynamic_t>(context, "manifests", name_))
+{}
+
+manifest_t::manifest_t(context_t& context, const std::string& name_, cached<dynamic_t> source):
+    cached<dynamic_t>(std::move(source)),
     name(name_)
 {
     endpoint = cocaine::format("{}/{}.{}", context.config().path().runtime(), name, ::getpid());
@@ -21,16 +21,21 @@ overseer_t::overseer_t(context_t& context,
                        manifest_t manifest,
                        profile_t profile,
                        std::shared_ptr<pool_observer> observer,
-                       std::shared_ptr<asio::io_service> loop)
+                       std::shared_ptr<asio::io_service> loop,
+                       std::shared_ptr<metrics_poller_t> metrics_poller)
     : engine(std::make_shared<engine_t>(context, manifest, profile, observer, loop))
 {
     try {
-        engine->start_isolate_metrics_poll();
+        engine->start_isolate_metrics_poll(std::move(metrics_poller));
     } catch(const error_t& err) {
         COCAINE_LOG_WARNING(engine->log,
             "failed to init metrics poll sequence: error code {}, reason {}",
             err.code(), err.what());
     }
+
+    engine->warm_up();
+    engine->start_queue_sweep();
+    engine->start_recycling();
 }
 
 overseer_t::~overseer_t() {
@@ -28,7 +28,11 @@
 namespace cocaine {
 
 profile_t::profile_t(context_t& context, const std::string& name_):
-    cached<dynamic_t>(context, "profiles", name_),
+    profile_t(name_, cached<dynamic_t>(context, "profiles", name_))
+{}
+
+profile_t::profile_t(const std::string& name_, cached<dynamic_t> source):
+    cached<dynamic_t>(std::move(source)),
     name(name_)
 {
     const auto& config = as_object();
@@ -45,6 +49,7 @@ profile_t::profile_t(context_t& context, const std::string& name_):
 
     concurrency         = as_object().at("concurrency", 10L).to<uint64_t>();
     crashlog_limit      = as_object().at("crashlog-limit", 50L).to<uint64_t>();
+    crashlog_size       = as_object().at("crashlog-size", 65536L).to<uint64_t>();
     pool_limit          = as_object().at("pool-limit", 10L).to<uint64_t>();
     queue_limit         = as_object().at("queue-limit", 100L).to<uint64_t>();
 
@@ -52,6 +57,46 @@ profile_t::profile_t(context_t& context, const std::string& name_):
 
     grow_threshold      = as_object().at("grow-threshold", default_threshold).to<uint64_t>();
 
+    queue_discipline    = as_object().at("queue-discipline", "fifo").as_string();
+    queue_sweep         = as_object().at("queue-sweep-interval", 0.0).to<double>();
+    info_staleness      = as_object().at("info-staleness", 1.0).to<double>();
+
+    // Fair queuing
+
+    const auto fair_config = as_object().at("fair-queue", dynamic_t::empty_object).as_object();
+
+    fair.header = fair_config.at("header", "").as_string();
+
+    for (const auto& weight : fair_config.at("weights", dynamic_t::empty_object).as_object()) {
+        fair.weights[weight.first] = weight.second.to<double>();
+    }
+
+    // Crashlog uploading
+
+    const auto crashlog_config = as_object().at("crashlog-upload", dynamic_t::empty_object).as_object();
+
+    crashlog_upload.queue_limit = crashlog_config.at("queue-limit", 64L).to<uint64_t>();
+    crashlog_upload.rate        = crashlog_config.at("rate", 1.0).to<double>();
+    crashlog_upload.burst       = crashlog_config.at("burst", 10L).to<uint64_t>();
+    crashlog_upload.concurrency = crashlog_config.at("concurrency", 4L).to<uint64_t>();
+    crashlog_upload.dedup_window = crashlog_config.at("dedup-window", 300.0).to<double>();
+
+    // Warm pool
+
+    const auto warm_config = as_object().at("warm-pool", dynamic_t::empty_object).as_object();
+
+    warm.spare   = warm_config.at("spare", 0L).to<uint64_t>();
+    warm.horizon = warm_config.at("horizon", 0.0).to<double>();
+
+    // Recycling
+
+    const auto recycle_config = as_object().at("recycle", dynamic_t::empty_object).as_object();
+
+    recycle.requests = recycle_config.at("requests", 0L).to<uint64_t>();
+    recycle.uptime   = recycle_config.at("uptime", 0.0).to<double>();
+    recycle.memory   = recycle_config.at("memory", 0L).to<uint64_t>();
+    recycle.interval = recycle_config.at("interval", 1.0).to<double>();
+
     // Isolation
 
     const auto isolate_config = as_object().at("isolate", dynamic_t::empty_object).as_object();
@@ -73,6 +118,56 @@ profile_t::profile_t(context_t& context, const std::string& name_):
         throw cocaine::error_t("engine concurrency must be positive");
     }
 
+    if (queue_discipline != "fifo" && queue_discipline != "edf") {
+        throw cocaine::error_t("queue discipline must be either 'fifo' or 'edf'");
+    }
+
+    if (queue_sweep < 0) {
+        throw cocaine::error_t("queue sweep interval must not be negative");
+    }
+
+    if (info_staleness < 0) {
+        throw cocaine::error_t("info staleness must not be negative");
+    }
+
+    for (const auto& weight : fair.weights) {
+        if (weight.second <= 0) {
+            throw cocaine::error_t("fair queue weights must be positive");
+        }
+    }
+
+    if (crashlog_upload.rate < 0) {
+        throw cocaine::error_t("crashlog upload rate must not be negative");
+    }
+
+    if (crashlog_upload.burst == 0) {
+        throw cocaine::error_t("crashlog upload burst must be positive");
+    }
+
+    if (crashlog_upload.concurrency == 0) {
+        throw cocaine::error_t("crashlog upload concurrency must be positive");
+    }
+
+    if (crashlog_upload.dedup_window < 0) {
+        throw cocaine::error_t("crashlog dedup window must not be negative");
+    }
+
+    if (warm.spare > pool_limit) {
+        throw cocaine::error_t("warm pool spare slaves count must not be greater than pool limit");
+    }
+
+    if (warm.horizon < 0) {
+        throw cocaine::error_t("warm pool forecast horizon must not be negative");
+    }
+
+    if (recycle.uptime < 0) {
+        throw cocaine::error_t("recycle uptime must not be negative");
+    }
+
+    if (recycle.interval <= 0) {
+        throw cocaine::error_t("recycle check interval must be positive");
+    }
+
     if (publish_on() > pool_limit) {
         throw cocaine::error_t("publish threshold must not be greater than pool limit");
     }
@@ -0,0 +1,148 @@
+#include "resolver.hpp"
+
+#include <cocaine/context.hpp>
+#include <cocaine/dynamic.hpp>
+#include <cocaine/errors.hpp>
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+namespace ph = std::placeholders;
+
+namespace conf {
+    // Cached profiles would hide updates from an explicit app restart, so only coalescing is done
+    // unless configured otherwise.
+    constexpr auto profile_cache_ttl_s = 0u;
+}
+
+namespace {
+
+template<class T>
+auto
+deliver(const std::function<void(std::future<T>)>& callback, const std::function<T()>& make) -> void {
+    std::promise<T> promise;
+
+    try {
+        promise.set_value(make());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+
+    callback(promise.get_future());
+}
+
+}  // namespace
+
+resolver_t::resolver_t(context_t& context, std::chrono::seconds ttl) :
+    context(context),
+    ttl(ttl)
+{}
+
+auto
+resolver_t::make(context_t& context, const dynamic_t& args) -> std::shared_ptr<resolver_t> {
+    const auto& object = args.as_object();
+
+    return std::make_shared<resolver_t>(
+        context,
+        std::chrono::seconds(object.at("profile_cache_ttl_s", conf::profile_cache_ttl_s).as_uint()));
+}
+
+auto
+resolver_t::manifest(const std::string& name, manifest_callback callback) -> void {
+    auto& context = this->context;
+
+    cached<dynamic_t>::fetch(context, "manifests", name, [=, &context](std::future<cached<dynamic_t>> future) {
+        deliver<manifest_t>(callback, [&] {
+            return manifest_t(context, name, future.get());
+        });
+    });
+}
+
+auto
+resolver_t::profile(const std::string& name, profile_callback callback) -> void {
+    const auto now = std::chrono::steady_clock::now();
+
+    std::shared_ptr<const profile_t> hit;
+    bool fetch = false;
+
+    profiles.apply([&](std::map<std::string, entry_t>& profiles) {
+        auto it = profiles.find(name);
+
+        if (it != profiles.end() && it->second.profile) {
+            if (it->second.expires > now) {
+                hit = it->second.profile;
+                return;
+            }
+
+            profiles.erase(it);
+            it = profiles.end();
+        }
+
+        if (it == profiles.end()) {
+            it = profiles.insert(std::make_pair(name, entry_t())).first;
+            fetch = true;
+        }
+
+        it->second.pending.push_back(std::move(callback));
+    });
+
+    if (hit) {
+        deliver<profile_t>(callback, [&] {
+            return *hit;
+        });
+        return;
+    }
+
+    if (fetch) {
+        cached<dynamic_t>::fetch(context, "profiles", name,
+            std::bind(&resolver_t::on_profile, shared_from_this(), name, ph::_1));
+    }
+}
+
+auto
+resolver_t::on_profile(const std::string& name, std::future<cached<dynamic_t>> future) -> void {
+    std::shared_ptr<const profile_t> profile;
+    std::exception_ptr error;
+
+    try {
+        profile = std::make_shared<const profile_t>(name, future.get());
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::vector<profile_callback> pending;
+
+    profiles.apply([&](std::map<std::string, entry_t>& profiles) {
+        auto it = profiles.find(name);
+        if (it == profiles.end()) {
+            return;
+        }
+
+        pending.swap(it->second.pending);
+
+        // Failures are never cached, the next request retries.
+        if (profile && ttl.count() > 0) {
+            it->second.profile = profile;
+            it->second.expires = std::chrono::steady_clock::now() + ttl;
+        } else {
+            profiles.erase(it);
+        }
+    });
+
+    for (const auto& callback : pending) {
+        deliver<profile_t>(callback, [&]() -> profile_t {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+
+            return *profile;
+        });
+    }
+}
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
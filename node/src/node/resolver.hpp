@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cocaine/forwards.hpp>
+#include <cocaine/locked_ptr.hpp>
+
+#include "cocaine/service/node/manifest.hpp"
+#include "cocaine/service/node/profile.hpp"
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+
+/// Resolves application manifests and profiles without blocking the caller.
+///
+/// Profiles are usually shared between many applications, so concurrent requests for the same
+/// profile are coalesced into a single storage request. This way starting a runlist resolves each
+/// distinct profile once. The parsed result may additionally be kept in memory for a configured
+/// while, which is disabled by default, because an app restarted within it would miss profile
+/// updates. Manifests are unique per application and are never cached.
+class resolver_t:
+    public std::enable_shared_from_this<resolver_t>
+{
+public:
+    typedef std::function<void(std::future<manifest_t>)> manifest_callback;
+    typedef std::function<void(std::future<profile_t>)> profile_callback;
+
+private:
+    struct entry_t {
+        /// Null while the profile is being fetched.
+        std::shared_ptr<const profile_t> profile;
+        std::chrono::steady_clock::time_point expires;
+
+        /// Requests waiting for the profile being fetched.
+        std::vector<profile_callback> pending;
+    };
+
+    context_t& context;
+
+    /// How long resolved profiles are served from memory, zero disables caching, but concurrent
+    /// requests are still coalesced.
+    const std::chrono::seconds ttl;
+
+    synchronized<std::map<std::string, entry_t>> profiles;
+
+public:
+    resolver_t(context_t& context, std::chrono::seconds ttl);
+
+    static
+    auto
+    make(context_t& context, const dynamic_t& args) -> std::shared_ptr<resolver_t>;
+
+    /// The callback is invoked exactly once, possibly from within a storage thread.
+    auto
+    manifest(const std::string& name, manifest_callback callback) -> void;
+
+    /// The callback is invoked exactly once, possibly from within this call or a storage thread.
+    auto
+    profile(const std::string& name, profile_callback callback) -> void;
+
+private:
+    auto
+    on_profile(const std::string& name, std::future<cached<dynamic_t>> future) -> void;
+};
+
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
@@ -41,9 +41,15 @@ slave_t::slave_t(context_t& context,
                  profile_t profile,
                  std::shared_ptr<api::authentication_t> auth,
                  asio::io_service& loop,
-                 cleanup_handler fn)
+                 cleanup_handler fn,
+                 balance_handler_t balance,
+                 std::shared_ptr<util::histogram_t> responses,
+                 std::shared_ptr<crashlog_writer_t> crashlogs,
+                 std::shared_ptr<slave::transitions_t> transitions)
     : ec(error::overseer_shutdowning),
-      machine(std::make_shared<machine_t>(context, id, manifest, profile, std::move(auth), loop, fn))
+      machine(std::make_shared<machine_t>(context, id, manifest, profile, std::move(auth), loop, fn,
+                                          std::move(balance), std::move(responses), std::move(crashlogs),
+                                          std::move(transitions)))
 {
     machine->start();
 
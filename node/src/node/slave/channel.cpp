@@ -3,6 +3,7 @@
 #include "cocaine/detail/service/node/dispatch/client.hpp"
 #include "cocaine/detail/service/node/dispatch/worker.hpp"
 #include "cocaine/detail/service/node/slave/channel.hpp"
+#include "cocaine/detail/service/node/slave/machine.hpp"
 
 namespace cocaine {
 namespace detail {
@@ -10,12 +11,16 @@ namespace service {
 namespace node {
 namespace slave {
 
-channel_t::channel_t(std::uint64_t id, time_point birthstamp, callback_type callback)
+channel_t::channel_t(std::uint64_t id, time_point birthstamp, std::shared_ptr<machine_t> slave,
+                     handler_type handler)
     : id_(id),
       birthstamp_(birthstamp),
-      callback(std::move(callback)),
+      injected_(std::chrono::high_resolution_clock::now()),
+      slave(std::move(slave)),
+      handler(std::move(handler)),
       state(both),
-      watched(false) {}
+      watched(false),
+      timeout{nullptr, nullptr, 0, 0, false} {}
 
 auto channel_t::id() const noexcept -> std::uint64_t {
     return id_;
@@ -25,6 +30,10 @@ auto channel_t::birthstamp() const -> channel_t::time_point {
     return birthstamp_;
 }
 
+auto channel_t::injected() const -> channel_t::time_point {
+    return injected_;
+}
+
 auto channel_t::close_send() -> void {
     std::lock_guard<std::mutex> lock(mutex);
     state &= ~side_t::tx;
@@ -63,7 +72,7 @@ auto channel_t::watch() -> void {
 
 auto channel_t::maybe_notify(std::lock_guard<std::mutex>&) -> void {
     if (closed() && watched) {
-        callback();
+        slave->revoke(id_, handler);
         into_worker.reset();
         from_worker.reset();
     }
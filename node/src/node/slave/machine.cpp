@@ -1,9 +1,5 @@
 #include "cocaine/detail/service/node/slave.hpp"
 
-#include <boost/algorithm/string/join.hpp>
-#include <boost/range/adaptor/map.hpp>
-#include <boost/range/algorithm/min_element.hpp>
-
 #include <blackhole/logger.hpp>
 
 #include <metrics/gauge.hpp>
@@ -31,6 +27,12 @@
 #include "cocaine/detail/service/node/slave/state/preparation.hpp"
 #include "cocaine/detail/service/node/slave/state/spawn.hpp"
 #include "cocaine/detail/service/node/slave/stats.hpp"
+#include "cocaine/detail/service/node/slave/timeout.hpp"
+#include "node/slave/transitions.hpp"
+
+#include "node/crashlog.hpp"
+
+#include <algorithm>
 
 namespace cocaine {
 namespace detail {
@@ -71,7 +73,11 @@ machine_t::machine_t(context_t& context,
                      profile_t profile,
                      std::shared_ptr<api::authentication_t> auth,
                      asio::io_service& loop,
-                     cleanup_handler cleanup):
+                     cleanup_handler cleanup,
+                     balance_handler_t balance,
+                     std::shared_ptr<util::histogram_t> responses,
+                     std::shared_ptr<crashlog_writer_t> crashlogs,
+                     std::shared_ptr<transitions_t> transitions):
     log(context.log(format("{}/slave", manifest.name), {{ "uuid", id.id() }})),
     context(context),
     id(id),
@@ -81,12 +87,24 @@ machine_t::machine_t(context_t& context,
     loop(loop),
     closed(false),
     cleanup(std::move(cleanup)),
-    lines(profile.crashlog_limit),
+    balance(std::move(balance)),
+    responses(std::move(responses)),
+    crashlogs(std::move(crashlogs)),
+    transitions(std::move(transitions)),
+    lines(profile.crashlog_size, profile.crashlog_limit),
     shutdowned(false),
+    migrated(std::chrono::high_resolution_clock::now()),
+    activated(false),
     counter(1),
+    inflight(0),
+    timeouts(std::make_shared<timeout_wheel_t>(loop, std::chrono::milliseconds(10), 1024)),
     birthstamp(clock_type::now()),
     metrics(nullptr)
 {
+    // Cache up to the maximum number of simultaneously processed channels.
+    pools.channels = std::make_shared<util::block_pool_t>(profile.concurrency);
+    pools.dispatches = std::make_shared<util::block_pool_t>(profile.concurrency);
+
     metrics_data.load.reset(new machine_t::ewma_type(std::chrono::seconds(10)));
     metrics_data.load->add(0.0);
 
@@ -125,15 +143,12 @@ machine_t::uptime() const -> std::chrono::seconds {
 
 bool
 machine_t::active() const noexcept {
-    auto state = *this->state.synchronize();
-    BOOST_ASSERT(state);
-
-    return state->active();
+    return activated.load();
 }
 
 std::uint64_t
 machine_t::load() const {
-    return data.channels->size();
+    return inflight.load();
 }
 
 auto machine_t::stats() const -> stats_t {
@@ -155,15 +170,8 @@ auto machine_t::stats() const -> stats_t {
         result.load = channels.size();
         result.total = counter - 1;
 
-        typedef std::shared_ptr<channel_t> value_type;
-
-        const auto range = channels | boost::adaptors::map_values;
-        const auto channel = boost::min_element(range, +[](const value_type& cur, const value_type& first) -> bool {
-            return cur->birthstamp() < first->birthstamp();
-        });
-
-        if (channel != boost::end(range)) {
-            result.age.reset((*channel)->birthstamp());
+        if (!data.births.empty()) {
+            result.age.reset(data.births.front().second);
         }
     });
 
@@ -181,14 +189,17 @@ machine_t::activate(std::shared_ptr<session_t> session, upstream<io::worker::con
 auto machine_t::inject(load_t& load, channel_handler handler) -> std::uint64_t {
     const auto id = ++counter;
 
-    auto channel = std::make_shared<channel_t>(
+    auto channel = std::allocate_shared<channel_t>(
+        util::pool_allocator<channel_t>(pools.channels),
         id,
         load.event.birthstamp,
-        std::bind(&machine_t::revoke, shared_from_this(), id, handler)
+        shared_from_this(),
+        std::move(handler)
     );
 
     // W2C dispatch.
-    auto dispatch = std::make_shared<worker_rpc_dispatch_t>(
+    auto dispatch = std::allocate_shared<worker_rpc_dispatch_t>(
+        util::pool_allocator<worker_rpc_dispatch_t>(pools.dispatches),
         load.downstream,
         trace_t::bind([=](const std::error_code& ec) {
             if (ec) {
@@ -208,10 +219,16 @@ auto machine_t::inject(load_t& load, channel_handler handler) -> std::uint64_t {
 
     const auto current = data.channels.apply([&](channels_map_t& channels) -> std::uint64_t {
         channels[id] = channel;
+        data.births.emplace_back(id, channel->birthstamp());
 
         const auto load = channels.size();
+        inflight.store(load);
         metrics_data.load->add(load);
 
+        if (balance.load) {
+            balance.load(load);
+        }
+
         return load;
     });
 
@@ -225,30 +242,13 @@ auto machine_t::inject(load_t& load, channel_handler handler) -> std::uint64_t {
         std::chrono::milliseconds
     >(load.event.birthstamp + request_timeout - std::chrono::high_resolution_clock::now()).count();
 
-    auto into_worker_dispatch = load.dispatch;
-    auto from_worker_dispatch = dispatch;
-
     if (duration <= 0) {
         COCAINE_LOG_ERROR(log, "channel {} has timed out immediately, closing", id);
-        into_worker_dispatch->discard(error::timeout_error);
-        from_worker_dispatch->discard(error::timeout_error);
+        load.dispatch->discard(error::timeout_error);
+        dispatch->discard(error::timeout_error);
     } else {
-        auto this_ = shared_from_this();
-
-        auto timer = std::make_shared<asio::deadline_timer>(loop);
-        data.timers.apply([&](timers_map_t& timers) {
-            timers[id] = timer;
-        });
-        timer->expires_from_now(boost::posix_time::milliseconds(duration));
-        timer->async_wait(trace_t::bind([=](const std::error_code& ec) mutable {
-            if (ec == asio::error::operation_aborted) {
-                return;
-            }
-
-            COCAINE_LOG_ERROR(this_->log, "channel {} has timed out, closing", id);
-            into_worker_dispatch->discard(error::timeout_error);
-            from_worker_dispatch->discard(error::timeout_error);
-        }));
+        // It's safe to track the raw channel here, because it can't be revoked until watched.
+        timeouts->schedule(*channel, std::chrono::milliseconds(duration));
     }
 
     COCAINE_LOG_DEBUG(log, "slave has started processing {} channel", id);
@@ -293,23 +293,23 @@ machine_t::terminate(std::error_code ec) {
 
 void
 machine_t::output(const char* data, size_t size) {
-    output(std::string(data, size));
-}
-
-void
-machine_t::output(const std::string& data) {
     splitter.apply([&](splitter_t& splitter) {
-        splitter.consume(data);
+        splitter.consume(data, size);
         while (auto line = splitter.next()) {
-            lines.push_back(*line);
+            lines.push(*line);
 
             if (profile.log_output) {
-                COCAINE_LOG_DEBUG(log, "slave's output: `{}`", *line);
+                COCAINE_LOG_DEBUG(log, "slave's output: `{}`", line->to_string());
             }
         }
     });
 }
 
+void
+machine_t::output(const std::string& data) {
+    output(data.data(), data.size());
+}
+
 void
 machine_t::migrate(std::shared_ptr<state_t> target) {
     BOOST_ASSERT(target);
@@ -317,7 +317,20 @@ machine_t::migrate(std::shared_ptr<state_t> target) {
     state.apply([&](std::shared_ptr<state_t>& state) {
         COCAINE_LOG_DEBUG(log, "slave has changed its state from '{}' to '{}'",
             state ? state->name() : "null", target->name());
+
+        const auto now = std::chrono::high_resolution_clock::now();
+        if (transitions) {
+            transitions->record(id.id(), state ? state->name() : nullptr, target->name(),
+                std::chrono::duration_cast<std::chrono::microseconds>(now - migrated));
+        }
+        migrated = now;
+
+        activated.store(target->active());
         state.swap(target);
+
+        if (balance.activity) {
+            balance.activity(state->active());
+        }
     });
 }
 
@@ -341,9 +354,7 @@ machine_t::shutdown(std::error_code ec) {
         dump();
     }
 
-    data.timers.apply([&](timers_map_t& timers) {
-        timers.clear();
-    });
+    timeouts->clear();
 
     data.channels.apply([&](channels_map_t& channels) {
         const auto size = channels.size();
@@ -358,7 +369,13 @@ machine_t::shutdown(std::error_code ec) {
         }
 
         channels.clear();
+        data.births.clear();
+        inflight.store(0);
         metrics_data.load->add(channels.size());
+
+        if (balance.load) {
+            balance.load(0);
+        }
     });
 
     // Check if the slave has been terminated externally. If so, do not call the cleanup callback.
@@ -380,18 +397,33 @@ machine_t::shutdown(std::error_code ec) {
 }
 
 void
-machine_t::revoke(std::uint64_t id, channel_handler handler) {
+machine_t::revoke(std::uint64_t id, const channel_handler& handler) {
     const auto load = data.channels.apply([&](channels_map_t& channels) -> std::uint64_t {
-        channels.erase(id);
+        auto it = channels.find(id);
+        if (it != channels.end()) {
+            const auto& channel = it->second;
+            timeouts->cancel(*channel);
+
+            if (responses && channel->from_worker) {
+                if (auto responded = channel->from_worker->responded()) {
+                    responses->record(std::chrono::duration_cast<std::chrono::microseconds>(
+                        *responded - channel->injected()).count());
+                }
+            }
+
+            channels.erase(it);
+            prune(channels);
+        }
 
         const auto load = channels.size();
+        inflight.store(load);
         metrics_data.load->add(load);
 
-        return load;
-    });
+        if (balance.load) {
+            balance.load(load);
+        }
 
-    data.timers.apply([&](timers_map_t& timers) {
-        timers.erase(id);
+        return load;
     });
 
     COCAINE_LOG_DEBUG(log, "slave has decreased its load to {}", load, attribute_list({{"channel", id}}));
@@ -410,6 +442,25 @@ machine_t::revoke(std::uint64_t id, channel_handler handler) {
     handler(id);
 }
 
+void
+machine_t::prune(const channels_map_t& channels) {
+    auto& births = data.births;
+
+    while (!births.empty() && channels.count(births.front().first) == 0) {
+        births.pop_front();
+    }
+
+    // A long-running channel at the front keeps the revoked ones behind it, compacting them at
+    // twice the live size keeps the cost amortized constant.
+    if (births.size() > 2 * channels.size() + 16) {
+        const auto revoked = [&](const births_t::value_type& birth) {
+            return channels.count(birth.first) == 0;
+        };
+
+        births.erase(std::remove_if(births.begin(), births.end(), revoked), births.end());
+    }
+}
+
 void
 machine_t::dump() {
     auto dump = splitter.apply([&](const splitter_t& splitter) {
@@ -418,11 +469,11 @@ machine_t::dump() {
             return dump;
         }
 
-        std::copy(std::begin(lines), std::end(lines), std::back_inserter(dump));
+        dump = lines.lines();
 
         // Copy the last unsplitted output.
         if (!splitter.empty()) {
-            dump.emplace_back(splitter.data());
+            dump.emplace_back(splitter.data().to_string());
         }
 
         return dump;
@@ -433,34 +484,9 @@ machine_t::dump() {
         return;
     }
 
-    const auto now = std::chrono::system_clock::now().time_since_epoch();
-
-    const auto us = std::chrono::duration_cast<
-        std::chrono::microseconds
-    >(now).count();
-
-    const auto key = format("{}:{}", us, id.id());
-
-    std::vector<std::string> indexes{manifest.name};
-
-    std::time_t time = std::time(nullptr);
-    char buf[64];
-    if (auto len = std::strftime(buf, sizeof(buf), "cocaine-%Y-%m-%d", std::gmtime(&time))) {
-        indexes.emplace_back(buf, len);
+    if (crashlogs) {
+        crashlogs->push(id.id(), std::move(dump));
     }
-
-    COCAINE_LOG_INFO(log, "slave is dumping output to 'crashlogs/{}' using [{}] indexes",
-                     key, boost::join(indexes, ", "));
-
-    // TODO: this one is really only used to log any error during crashlog write. Maybe we can do it in a better way
-    auto self = shared_from_this();
-    api::storage(context, "core")->put("crashlogs", key, dump, indexes, [=](std::future<void> future) {
-        try {
-            future.get();
-        } catch (const std::exception& e) {
-            COCAINE_LOG_WARNING(self->log, "slave is unable to save the crashlog: {}", e.what());
-        }
-    });
 }
 
 }  // namespace slave
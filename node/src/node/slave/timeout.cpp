@@ -0,0 +1,162 @@
+#include "cocaine/detail/service/node/slave/timeout.hpp"
+
+#include <boost/assert.hpp>
+
+#include "cocaine/service/node/slave/error.hpp"
+
+#include "cocaine/detail/service/node/dispatch/client.hpp"
+#include "cocaine/detail/service/node/dispatch/worker.hpp"
+#include "cocaine/detail/service/node/slave/channel.hpp"
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+namespace slave {
+
+namespace ph = std::placeholders;
+
+timeout_wheel_t::timeout_wheel_t(asio::io_service& loop, duration_type resolution, std::size_t size) :
+    timer(loop),
+    resolution(resolution),
+    slots(size, nullptr),
+    cursor(0),
+    size(0),
+    ticking(false)
+{
+    BOOST_ASSERT(size > 0);
+    BOOST_ASSERT(resolution.count() > 0);
+}
+
+auto timeout_wheel_t::schedule(channel_t& channel, duration_type timeout) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    BOOST_ASSERT(!channel.timeout.linked);
+
+    // Number of ticks to wait, rounded up. The slot is visited every `slots.size()` ticks, so
+    // skip all visits before the required one.
+    const std::uint64_t ticks = std::max<std::uint64_t>(1, (timeout.count() + resolution.count() - 1) / resolution.count());
+
+    channel.timeout.rounds = (ticks - 1) / slots.size();
+    link(channel, (cursor + ticks) % slots.size());
+
+    if (!ticking) {
+        start(lock);
+    }
+}
+
+auto timeout_wheel_t::cancel(channel_t& channel) -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (channel.timeout.linked) {
+        unlink(channel);
+    }
+}
+
+auto timeout_wheel_t::clear() -> void {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& head : slots) {
+        while (head) {
+            unlink(*head);
+        }
+    }
+
+    if (ticking) {
+        std::error_code ec;
+        timer.cancel(ec);
+        ticking = false;
+    }
+}
+
+auto timeout_wheel_t::link(channel_t& channel, std::size_t slot) -> void {
+    auto& head = slots[slot];
+
+    channel.timeout.slot = slot;
+    channel.timeout.prev = nullptr;
+    channel.timeout.next = head;
+    channel.timeout.linked = true;
+
+    if (head) {
+        head->timeout.prev = &channel;
+    }
+
+    head = &channel;
+    ++size;
+}
+
+auto timeout_wheel_t::unlink(channel_t& channel) -> void {
+    auto& hook = channel.timeout;
+
+    if (hook.prev) {
+        hook.prev->timeout.next = hook.next;
+    } else {
+        slots[hook.slot] = hook.next;
+    }
+
+    if (hook.next) {
+        hook.next->timeout.prev = hook.prev;
+    }
+
+    hook.prev = nullptr;
+    hook.next = nullptr;
+    hook.linked = false;
+    --size;
+}
+
+auto timeout_wheel_t::start(std::lock_guard<std::mutex>&) -> void {
+    ticking = true;
+    timer.expires_from_now(boost::posix_time::milliseconds(resolution.count()));
+    timer.async_wait(std::bind(&timeout_wheel_t::on_tick, shared_from_this(), ph::_1));
+}
+
+auto timeout_wheel_t::on_tick(const std::error_code& ec) -> void {
+    if (ec == asio::error::operation_aborted) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!ticking) {
+            return;
+        }
+
+        cursor = (cursor + 1) % slots.size();
+
+        auto channel = slots[cursor];
+        while (channel) {
+            auto next = channel->timeout.next;
+
+            if (channel->timeout.rounds > 0) {
+                --channel->timeout.rounds;
+            } else {
+                expired.emplace_back(channel->into_worker, channel->from_worker);
+                unlink(*channel);
+            }
+
+            channel = next;
+        }
+
+        if (size > 0) {
+            // Schedule relatively to the previous expiration to avoid drift.
+            timer.expires_at(timer.expires_at() + boost::posix_time::milliseconds(resolution.count()));
+            timer.async_wait(std::bind(&timeout_wheel_t::on_tick, shared_from_this(), ph::_1));
+        } else {
+            ticking = false;
+        }
+    }
+
+    for (auto& dispatches : expired) {
+        dispatches.first->discard(error::timeout_error);
+        dispatches.second->discard(error::timeout_error);
+    }
+
+    expired.clear();
+}
+
+}  // namespace slave
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
@@ -0,0 +1,129 @@
+#include "transitions.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+namespace slave {
+
+namespace {
+
+typedef std::array<char, 5 * sizeof(std::uint64_t)> id_buffer_t;
+
+}  // namespace
+
+constexpr std::size_t transitions_t::capacity;
+
+const std::array<const char*, 6> transitions_t::states = {{
+    "preparation",
+    "spawning",
+    "handshaking",
+    "active",
+    "sealing",
+    "terminating",
+}};
+
+transitions_t::transitions_t() :
+    cursor(0)
+{
+    for (auto& slot : slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+auto
+transitions_t::record(const std::string& id, const char* from, const char* to,
+                      std::chrono::microseconds duration) -> void
+{
+    const auto ticket = cursor.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = slots[ticket % capacity];
+
+    slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    id_buffer_t buffer{};
+    std::memcpy(buffer.data(), id.data(), std::min(id.size(), buffer.size()));
+
+    for (std::size_t i = 0; i < slot.id.size(); ++i) {
+        std::uint64_t word;
+        std::memcpy(&word, buffer.data() + i * sizeof(word), sizeof(word));
+        slot.id[i].store(word, std::memory_order_relaxed);
+    }
+
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+
+    slot.from.store(from, std::memory_order_relaxed);
+    slot.to.store(to, std::memory_order_relaxed);
+    slot.timestamp.store(now.count(), std::memory_order_relaxed);
+    slot.duration.store(duration.count(), std::memory_order_relaxed);
+
+    slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+
+    if (from == nullptr) {
+        return;
+    }
+
+    for (std::size_t state = 0; state < states.size(); ++state) {
+        if (std::strcmp(from, states[state]) == 0) {
+            durations[state].record(static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0)));
+            break;
+        }
+    }
+}
+
+auto
+transitions_t::recent() const -> std::vector<record_t> {
+    const auto end = cursor.load(std::memory_order_acquire);
+    const auto begin = end > capacity ? end - capacity : 0;
+
+    std::vector<record_t> result;
+    result.reserve(end - begin);
+
+    for (auto ticket = begin; ticket < end; ++ticket) {
+        const auto& slot = slots[ticket % capacity];
+
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * ticket + 2) {
+            continue;
+        }
+
+        id_buffer_t buffer;
+        for (std::size_t i = 0; i < slot.id.size(); ++i) {
+            const auto word = slot.id[i].load(std::memory_order_relaxed);
+            std::memcpy(buffer.data() + i * sizeof(word), &word, sizeof(word));
+        }
+
+        record_t record;
+        record.from = slot.from.load(std::memory_order_relaxed);
+        record.to = slot.to.load(std::memory_order_relaxed);
+        record.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<
+            std::chrono::system_clock::duration
+        >(std::chrono::microseconds(slot.timestamp.load(std::memory_order_relaxed))));
+        record.duration = std::chrono::microseconds(slot.duration.load(std::memory_order_relaxed));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+
+        record.id.assign(buffer.data(), ::strnlen(buffer.data(), buffer.size()));
+        result.push_back(std::move(record));
+    }
+
+    return result;
+}
+
+auto
+transitions_t::duration(std::size_t state) const -> const util::histogram_t& {
+    return durations.at(state);
+}
+
+}  // namespace slave
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
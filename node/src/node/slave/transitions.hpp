@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "util/histogram.hpp"
+
+namespace cocaine {
+namespace detail {
+namespace service {
+namespace node {
+namespace slave {
+
+/// Records state machine transitions of all slaves of an application.
+///
+/// The most recent transitions are kept in a fixed-size lock-free ring and the time spent in each
+/// state is aggregated into per-state histograms covering the last minute or two. Recording is a
+/// handful of relaxed atomic stores, nothing is formatted or allocated until the records are read.
+class transitions_t {
+public:
+    static constexpr std::size_t capacity = 256;
+
+    struct record_t {
+        /// Slave id.
+        std::string id;
+
+        /// State names, the first transition is recorded from the null state.
+        const char* from;
+        const char* to;
+
+        std::chrono::system_clock::time_point timestamp;
+
+        /// Time spent in the previous state.
+        std::chrono::microseconds duration;
+    };
+
+    /// Known states in the order of the slave lifecycle, durations are aggregated for them only.
+    static const std::array<const char*, 6> states;
+
+private:
+    /// Slot guarded by a sequence lock, fields are atomics to be copied without tearing.
+    ///
+    /// The sequence is odd while the slot is being written and even when it holds the record with
+    /// the `(sequence - 2) / 2` ticket.
+    struct slot_t {
+        std::atomic<std::uint64_t> sequence;
+
+        /// Slave id, truncated and padded with zeroes.
+        std::array<std::atomic<std::uint64_t>, 5> id;
+
+        std::atomic<const char*> from;
+        std::atomic<const char*> to;
+
+        /// Microseconds since the system clock epoch.
+        std::atomic<std::int64_t> timestamp;
+        std::atomic<std::int64_t> duration;
+    };
+
+    std::atomic<std::uint64_t> cursor;
+    std::array<slot_t, capacity> slots;
+
+    /// Time spent in each of the known states in microseconds.
+    std::array<util::histogram_t, std::tuple_size<decltype(states)>::value> durations;
+
+public:
+    transitions_t();
+
+    transitions_t(const transitions_t& other) = delete;
+    transitions_t& operator=(const transitions_t& other) = delete;
+
+    /// Records the transition, lock-free and safe to be called concurrently.
+    auto
+    record(const std::string& id, const char* from, const char* to,
+           std::chrono::microseconds duration) -> void;
+
+    /// Returns the recorded transitions from the oldest to the newest.
+    ///
+    /// Records being overwritten concurrently are skipped.
+    auto
+    recent() const -> std::vector<record_t>;
+
+    /// Returns the histogram of durations of the given known state.
+    auto
+    duration(std::size_t state) const -> const util::histogram_t&;
+};
+
+}  // namespace slave
+}  // namespace node
+}  // namespace service
+}  // namespace detail
+}  // namespace cocaine
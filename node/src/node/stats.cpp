@@ -1,6 +1,7 @@
 #include "cocaine/detail/service/node/stats.hpp"
 
 #include <cmath>
+#include <utility>
 
 #include <cocaine/context.hpp>
 #include <cocaine/format.hpp>
@@ -14,11 +15,31 @@ namespace {
 
 const char name_requests_accepted[] = "{}.requests.accepted";
 const char name_requests_rejected[] = "{}.requests.rejected";
+const char name_requests_expired[] = "{}.requests.expired";
 const char name_slaves_spawned[] = "{}.slaves.spawned";
 const char name_slaves_crashed[] = "{}.slaves.crashed";
+const char name_slaves_recycled[] = "{}.slaves.recycled";
+const char name_rebalance_invocations[] = "{}.rebalance.invocations";
+const char name_rebalance_coalesced[] = "{}.rebalance.coalesced";
+const char name_rebalance_moved[] = "{}.rebalance.moved";
+const char name_crashlogs_written[] = "{}.crashlogs.written";
+const char name_crashlogs_failed[] = "{}.crashlogs.failed";
+const char name_crashlogs_dropped[] = "{}.crashlogs.dropped";
+const char name_crashlogs_deduplicated[] = "{}.crashlogs.deduplicated";
 const char name_rate[] = "{}.rate";
 const char name_queue_depth_average[] = "{}.queue.depth_average";
 const char name_timings[] = "{}.timings";
+const char name_latency[] = "{}.latency.{}.{}";
+
+const std::vector<std::pair<const char*, util::histogram_t stats_t::latency_t::*>> latency_phases = {
+    {"queue", &stats_t::latency_t::queue},
+    {"response", &stats_t::latency_t::response},
+    {"channel", &stats_t::latency_t::channel}
+};
+
+const std::vector<std::pair<const char*, double>> latency_quantiles = {
+    {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p999", 0.999}
+};
 
 } // namespace
 
@@ -27,11 +48,24 @@ stats_t::stats_t(context_t& context, const std::string& name, std::chrono::high_
     metrics_hub(context.metrics_hub()),
     requests{
         metrics_hub.counter<std::int64_t>(cocaine::format(name_requests_accepted, name)),
-        metrics_hub.counter<std::int64_t>(cocaine::format(name_requests_rejected, name))
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_requests_rejected, name)),
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_requests_expired, name))
     },
     slaves{
         metrics_hub.counter<std::int64_t>(cocaine::format(name_slaves_spawned, name)),
-        metrics_hub.counter<std::int64_t>(cocaine::format(name_slaves_crashed, name))
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_slaves_crashed, name)),
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_slaves_recycled, name))
+    },
+    rebalance{
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_rebalance_invocations, name)),
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_rebalance_coalesced, name)),
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_rebalance_moved, name))
+    },
+    crashlogs{
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_crashlogs_written, name)),
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_crashlogs_failed, name)),
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_crashlogs_dropped, name)),
+        metrics_hub.counter<std::int64_t>(cocaine::format(name_crashlogs_deduplicated, name))
     },
     meter(metrics_hub.meter(cocaine::format(name_rate, name))),
     queue_depth(std::make_shared<metrics::usts::ewma_t>(interval)),
@@ -42,19 +76,52 @@ stats_t::stats_t(context_t& context, const std::string& name, std::chrono::high_
             std::bind(&metrics::usts::ewma_t::get, queue_depth)
         )
     ),
-    timer(metrics_hub.timer<metrics::accumulator::decaying::exponentially_t>(cocaine::format(name_timings, name)))
+    timer(metrics_hub.timer<metrics::accumulator::decaying::exponentially_t>(cocaine::format(name_timings, name))),
+    latency(std::make_shared<latency_t>())
 {
     queue_depth->add(0);
+
+    for (const auto& phase : latency_phases) {
+        for (const auto& quantile : latency_quantiles) {
+            const auto latency = this->latency;
+            const auto histogram = phase.second;
+            const auto q = quantile.second;
+
+            // Quantiles are reported in milliseconds.
+            latency_gauges.emplace_back(metrics_hub.register_gauge<double>(
+                cocaine::format(name_latency, name, phase.first, quantile.first),
+                {},
+                [=]() -> double {
+                    return static_cast<double>(((*latency).*histogram).snapshot().value(q)) / 1e3;
+                }
+            ));
+        }
+    }
 }
 
 auto stats_t::deregister() -> void {
     metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_requests_accepted, name), {});
     metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_requests_rejected, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_requests_expired, name), {});
     metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_slaves_spawned, name), {});
     metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_slaves_crashed, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_slaves_recycled, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_rebalance_invocations, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_rebalance_coalesced, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_rebalance_moved, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_crashlogs_written, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_crashlogs_failed, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_crashlogs_dropped, name), {});
+    metrics_hub.remove<std::atomic<std::int64_t>>(cocaine::format(name_crashlogs_deduplicated, name), {});
     metrics_hub.remove<metrics::meter_t>(cocaine::format(name_rate, name), {});
     metrics_hub.remove<metrics::gauge<double>>(cocaine::format(name_queue_depth_average, name), {});
     metrics_hub.remove<metrics::timer<metrics::accumulator::decaying::exponentially_t>>(cocaine::format(name_timings, name), {});
+
+    for (const auto& phase : latency_phases) {
+        for (const auto& quantile : latency_quantiles) {
+            metrics_hub.remove<metrics::gauge<double>>(cocaine::format(name_latency, name, phase.first, quantile.first), {});
+        }
+    }
 }
 
 } // namespace cocaine
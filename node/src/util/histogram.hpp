@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace cocaine {
+namespace util {
+
+/// Lock-free log-linear histogram of non-negative integer values in the HDR fashion.
+///
+/// Values are grouped into power-of-two ranges, each of them is split into `2^precision` linear
+/// sub-buckets, which bounds the relative error by `2^-precision`. Values up to `2^precision` are
+/// stored exactly, values above `2^limit` are clamped.
+///
+/// Counters are kept in two alternating generations, which are rotated lazily once per window, so
+/// quantiles reflect the last one to two windows rather than the whole lifetime. A few values
+/// recorded concurrently with a rotation may be lost.
+///
+/// Recording is a clock read and a relaxed atomic increment, so it's cheap enough for the request
+/// path.
+class histogram_t {
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    static constexpr unsigned precision = 5;
+    static constexpr unsigned limit = 40;
+    static constexpr std::size_t size = (limit - precision + 1) << precision;
+
+    /// Consistent enough copy of the histogram counters, used for quantiles calculation.
+    class snapshot_t {
+        std::vector<std::uint64_t> buckets;
+        std::uint64_t total;
+
+    public:
+        explicit
+        snapshot_t(const histogram_t& histogram) :
+            buckets(size),
+            total(0)
+        {
+            for (const auto& generation : histogram.generations) {
+                for (std::size_t i = 0; i < size; ++i) {
+                    buckets[i] += generation[i].load(std::memory_order_relaxed);
+                }
+            }
+
+            for (auto bucket : buckets) {
+                total += bucket;
+            }
+        }
+
+        auto
+        count() const noexcept -> std::uint64_t {
+            return total;
+        }
+
+        /// Returns the value at the given quantile, where quantile is in [0; 1] range.
+        auto
+        value(double quantile) const -> std::uint64_t {
+            if (total == 0) {
+                return 0;
+            }
+
+            const auto rank = static_cast<std::uint64_t>(quantile * static_cast<double>(total - 1)) + 1;
+
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return histogram_t::value(i);
+                }
+            }
+
+            return histogram_t::value(size - 1);
+        }
+    };
+
+private:
+    typedef std::array<std::atomic<std::uint64_t>, size> buckets_type;
+
+    mutable std::array<buckets_type, 2> generations;
+
+    /// Index of the current generation is its lowest bit.
+    mutable std::atomic<std::uint64_t> generation;
+
+    /// Time of the last rotation in clock ticks.
+    mutable std::atomic<clock_type::rep> rotated;
+
+    const clock_type::rep window;
+
+public:
+    explicit
+    histogram_t(clock_type::duration window = std::chrono::seconds(60)) :
+        generation(0),
+        rotated(clock_type::now().time_since_epoch().count()),
+        window(window.count())
+    {
+        for (auto& buckets : generations) {
+            clear(buckets);
+        }
+    }
+
+    histogram_t(const histogram_t& other) = delete;
+    histogram_t& operator=(const histogram_t& other) = delete;
+
+    auto
+    record(std::uint64_t value) -> void {
+        rotate();
+        const auto current = generation.load(std::memory_order_acquire) & 1;
+        generations[current][index(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto
+    snapshot() const -> snapshot_t {
+        rotate();
+        return snapshot_t(*this);
+    }
+
+private:
+    /// Starts a new generation once the window has passed, dropping the oldest one. Both are
+    /// dropped after two idle windows.
+    auto
+    rotate() const -> void {
+        const auto now = clock_type::now().time_since_epoch().count();
+        auto last = rotated.load(std::memory_order_relaxed);
+
+        if (now - last < window) {
+            return;
+        }
+
+        if (!rotated.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            return;
+        }
+
+        const auto current = generation.load(std::memory_order_relaxed);
+        if (now - last >= 2 * window) {
+            clear(generations[current & 1]);
+        }
+
+        clear(generations[(current + 1) & 1]);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+
+    static
+    auto
+    clear(buckets_type& buckets) -> void {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static
+    auto
+    index(std::uint64_t value) -> std::size_t {
+        if (value >= (std::uint64_t(1) << limit)) {
+            return size - 1;
+        }
+
+        if (value < (std::uint64_t(1) << precision)) {
+            return static_cast<std::size_t>(value);
+        }
+
+        const unsigned msb = 63 - __builtin_clzll(value);
+        const unsigned shift = msb - precision;
+
+        return ((shift + 1) << precision) + static_cast<std::size_t>((value >> shift) - (1u << precision));
+    }
+
+    /// Returns the middle of the bucket range.
+    static
+    auto
+    value(std::size_t index) -> std::uint64_t {
+        const auto group = index >> precision;
+        const auto sub = index & ((1u << precision) - 1);
+
+        if (group == 0) {
+            return sub;
+        }
+
+        const auto shift = group - 1;
+        const auto lower = (std::uint64_t(sub) + (1u << precision)) << shift;
+
+        return lower + ((std::uint64_t(1) << shift) >> 1);
+    }
+};
+
+}  // namespace util
+}  // namespace cocaine
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace cocaine {
+namespace util {
+
+/// Thread-safe free list of equally sized memory blocks.
+///
+/// Released blocks are cached for further reuse instead of returning them to the system allocator,
+/// which makes steady state allocations of same-typed objects cheap. The block size is fixed on the
+/// first allocation, blocks of other sizes are forwarded to the global allocator.
+class block_pool_t {
+    std::mutex mutex;
+
+    std::size_t size;
+    std::size_t limit;
+    std::vector<void*> blocks;
+
+public:
+    /// \param limit maximum number of cached blocks, other ones are released immediately.
+    explicit
+    block_pool_t(std::size_t limit) :
+        size(0),
+        limit(limit)
+    {
+        blocks.reserve(limit);
+    }
+
+    block_pool_t(const block_pool_t& other) = delete;
+    block_pool_t& operator=(const block_pool_t& other) = delete;
+
+    ~block_pool_t() {
+        for (auto block : blocks) {
+            ::operator delete(block);
+        }
+    }
+
+    auto
+    allocate(std::size_t size) -> void* {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (this->size == 0) {
+                this->size = size;
+            }
+
+            if (this->size == size && !blocks.empty()) {
+                auto block = blocks.back();
+                blocks.pop_back();
+                return block;
+            }
+        }
+
+        return ::operator new(size);
+    }
+
+    auto
+    deallocate(void* block, std::size_t size) -> void {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (this->size == size && blocks.size() < limit) {
+                blocks.push_back(block);
+                return;
+            }
+        }
+
+        ::operator delete(block);
+    }
+};
+
+/// Allocator adapter over the shared block pool, suitable for `std::allocate_shared`.
+///
+/// The pool is shared between all allocator copies, including the one stored inside the control
+/// block, so it outlives every object allocated from it.
+template<class T>
+class pool_allocator {
+    template<class U> friend class pool_allocator;
+
+    std::shared_ptr<block_pool_t> pool;
+
+public:
+    typedef T value_type;
+
+    template<class U>
+    struct rebind {
+        typedef pool_allocator<U> other;
+    };
+
+    explicit
+    pool_allocator(std::shared_ptr<block_pool_t> pool) :
+        pool(std::move(pool))
+    {}
+
+    template<class U>
+    pool_allocator(const pool_allocator<U>& other) :
+        pool(other.pool)
+    {}
+
+    auto
+    allocate(std::size_t n) -> T* {
+        return static_cast<T*>(pool->allocate(n * sizeof(T)));
+    }
+
+    auto
+    deallocate(T* p, std::size_t n) -> void {
+        pool->deallocate(p, n * sizeof(T));
+    }
+
+    template<class U>
+    auto
+    operator==(const pool_allocator<U>& other) const -> bool {
+        return pool == other.pool;
+    }
+
+    template<class U>
+    auto
+    operator!=(const pool_allocator<U>& other) const -> bool {
+        return pool != other.pool;
+    }
+};
+
+}  // namespace util
+}  // namespace cocaine
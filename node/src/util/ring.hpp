@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/circular_buffer.hpp>
+#include <boost/utility/string_ref.hpp>
+
+namespace cocaine {
+namespace util {
+
+/// Keeps the most recent lines in a fixed-size byte ring.
+///
+/// Line bytes are stored contiguously modulo the ring size, only their lengths are tracked
+/// separately, so pushing a line never allocates. The oldest lines are dropped when either the
+/// bytes or the lines limit is reached. A line larger than the whole ring keeps its tail only.
+class line_ring_t {
+    std::vector<char> ring;
+
+    /// Position of the first byte of the oldest line.
+    std::size_t head;
+
+    /// Number of bytes occupied by lines.
+    std::size_t used;
+
+    boost::circular_buffer<std::size_t> lengths;
+
+public:
+    /// \param size the ring size in bytes.
+    /// \param limit maximum number of lines to keep.
+    line_ring_t(std::size_t size, std::size_t limit) :
+        ring(size),
+        head(0),
+        used(0),
+        lengths(limit)
+    {}
+
+    auto
+    empty() const noexcept -> bool {
+        return lengths.empty();
+    }
+
+    auto
+    push(boost::string_ref line) -> void {
+        if (lengths.capacity() == 0 || ring.empty()) {
+            return;
+        }
+
+        if (line.size() > ring.size()) {
+            line = line.substr(line.size() - ring.size());
+        }
+
+        while (!lengths.empty() && (lengths.full() || used + line.size() > ring.size())) {
+            pop();
+        }
+
+        const auto tail = (head + used) % ring.size();
+        const auto first = std::min(line.size(), ring.size() - tail);
+
+        std::memcpy(ring.data() + tail, line.data(), first);
+        std::memcpy(ring.data(), line.data() + first, line.size() - first);
+
+        used += line.size();
+        lengths.push_back(line.size());
+    }
+
+    /// Copies all stored lines from the oldest to the newest.
+    auto
+    lines() const -> std::vector<std::string> {
+        std::vector<std::string> result;
+        result.reserve(lengths.size());
+
+        auto position = head;
+        for (auto length : lengths) {
+            std::string line;
+            line.reserve(length);
+
+            const auto first = std::min(length, ring.size() - position);
+            line.append(ring.data() + position, first);
+            line.append(ring.data(), length - first);
+
+            result.push_back(std::move(line));
+            position = (position + length) % ring.size();
+        }
+
+        return result;
+    }
+
+private:
+    auto
+    pop() -> void {
+        const auto length = lengths.front();
+        lengths.pop_front();
+
+        head = (head + length) % ring.size();
+        used -= length;
+    }
+};
+
+}  // namespace util
+}  // namespace cocaine
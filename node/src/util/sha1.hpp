@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace cocaine {
+namespace util {
+
+/// Incremental SHA-1 as specified by RFC 3174.
+///
+/// Used for content addressing only, where collision resistance against an adversary is not
+/// required.
+class sha1_t {
+public:
+    typedef std::array<std::uint8_t, 20> digest_type;
+
+private:
+    std::array<std::uint32_t, 5> state;
+    std::array<std::uint8_t, 64> block;
+    std::size_t filled;
+    std::uint64_t length;
+
+public:
+    sha1_t() :
+        state{{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0}},
+        block(),
+        filled(0),
+        length(0)
+    {}
+
+    auto update(const void* data, std::size_t size) -> void {
+        auto bytes = static_cast<const std::uint8_t*>(data);
+        length += size;
+
+        while (size > 0) {
+            const auto chunk = std::min(size, block.size() - filled);
+            std::memcpy(block.data() + filled, bytes, chunk);
+
+            filled += chunk;
+            bytes += chunk;
+            size -= chunk;
+
+            if (filled == block.size()) {
+                process();
+            }
+        }
+    }
+
+    /// Finishes hashing, the hasher must not be updated afterwards.
+    auto digest() -> digest_type {
+        const auto bits = length * 8;
+
+        const std::uint8_t pad = 0x80;
+        update(&pad, 1);
+
+        const std::uint8_t zero = 0;
+        while (filled != block.size() - 8) {
+            update(&zero, 1);
+        }
+
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            const auto byte = static_cast<std::uint8_t>(bits >> shift);
+            update(&byte, 1);
+        }
+
+        digest_type result;
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            result[i] = static_cast<std::uint8_t>(state[i / 4] >> (24 - 8 * (i % 4)));
+        }
+
+        return result;
+    }
+
+    /// Finishes hashing, returning the digest as a lowercase hex string.
+    auto hexdigest() -> std::string {
+        static const char alphabet[] = "0123456789abcdef";
+
+        std::string result;
+        for (auto byte : digest()) {
+            result.push_back(alphabet[byte >> 4]);
+            result.push_back(alphabet[byte & 0x0f]);
+        }
+
+        return result;
+    }
+
+private:
+    static auto rotl(std::uint32_t value, unsigned bits) -> std::uint32_t {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    auto process() -> void {
+        std::array<std::uint32_t, 80> w;
+
+        for (std::size_t i = 0; i < 16; ++i) {
+            w[i] = static_cast<std::uint32_t>(block[4 * i]) << 24 |
+                   static_cast<std::uint32_t>(block[4 * i + 1]) << 16 |
+                   static_cast<std::uint32_t>(block[4 * i + 2]) << 8 |
+                   static_cast<std::uint32_t>(block[4 * i + 3]);
+        }
+
+        for (std::size_t i = 16; i < w.size(); ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        auto a = state[0];
+        auto b = state[1];
+        auto c = state[2];
+        auto d = state[3];
+        auto e = state[4];
+
+        for (std::size_t i = 0; i < w.size(); ++i) {
+            std::uint32_t f;
+            std::uint32_t k;
+
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+
+            const auto temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+
+        filled = 0;
+    }
+};
+
+} // namespace util
+} // namespace cocaine
@@ -1,52 +1,86 @@
 #pragma once
 
+#include <cstring>
 #include <string>
 
 #include <boost/optional/optional.hpp>
+#include <boost/utility/string_ref.hpp>
 
 namespace cocaine {
 namespace util {
 
 /// Helper generator that consumes strings and yields them splitted by the given separator.
+///
+/// Yielded lines are views into the internal buffer, which are valid until the next `consume`
+/// call. The buffer is compacted lazily, only when the parsed prefix outweighs the unparsed tail,
+/// and already scanned bytes are never scanned twice, which makes splitting linear in the total
+/// size of consumed data.
 class splitter_t {
     char sep;
-    std::string unparsed;
+    std::string buffer;
+
+    /// Start of the unparsed data.
+    std::size_t offset;
+
+    /// Position from which to continue looking for the separator.
+    std::size_t scanned;
 
 public:
     splitter_t() :
-        sep('\n')
+        splitter_t('\n')
     {}
 
     explicit
     splitter_t(char sep) :
-        sep(sep)
+        sep(sep),
+        offset(0),
+        scanned(0)
     {}
 
-    boost::optional<std::string>
+    boost::optional<boost::string_ref>
     next() {
-        const auto pos = unparsed.find(sep);
-        if (pos == std::string::npos) {
+        const auto begin = buffer.data();
+        const auto found = static_cast<const char*>(
+            std::memchr(begin + scanned, sep, buffer.size() - scanned)
+        );
+
+        if (found == nullptr) {
+            scanned = buffer.size();
             return boost::none;
         }
 
-        auto line = unparsed.substr(0, pos);
-        unparsed.erase(0, pos + 1);
+        const auto pos = static_cast<std::size_t>(found - begin);
+
+        boost::string_ref line(begin + offset, pos - offset);
+        offset = pos + 1;
+        scanned = offset;
         return boost::make_optional(line);
     }
 
     bool
     empty() const {
-        return unparsed.empty();
+        return offset == buffer.size();
     }
 
-    const std::string&
+    boost::string_ref
     data() const {
-        return unparsed;
+        return boost::string_ref(buffer.data() + offset, buffer.size() - offset);
+    }
+
+    void
+    consume(const char* data, std::size_t size) {
+        if (offset > 0 && offset >= buffer.size() - offset) {
+            buffer.erase(0, offset);
+            scanned -= offset;
+            offset = 0;
+        }
+
+        buffer.append(data, size);
     }
 
     void
     consume(const std::string& data) {
-        unparsed.append(data);
+        consume(data.data(), data.size());
     }
 };
 
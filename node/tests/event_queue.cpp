@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "node/event_queue.hpp"
+
+namespace testing {
+
+using cocaine::detail::service::node::event_queue_t;
+using cocaine::detail::service::node::load_t;
+using cocaine::service::node::app::event_t;
+
+namespace {
+
+auto at(int seconds) -> load_t::time_point {
+    return load_t::time_point() + std::chrono::seconds(seconds);
+}
+
+auto make_load(const std::string& name, int birthstamp, int deadline) -> load_t {
+    load_t load{
+        event_t(name, {}),
+        cocaine::trace_t::current(),
+        nullptr,
+        nullptr,
+        at(deadline)
+    };
+
+    load.event.birthstamp = at(birthstamp);
+    return load;
+}
+
+auto drain(event_queue_t& queue) -> std::vector<std::string> {
+    std::vector<std::string> result;
+    while (!queue.empty()) {
+        result.push_back(queue.front().event.name);
+        queue.pop();
+    }
+
+    return result;
+}
+
+}  // namespace
+
+TEST(event_queue, serves_single_flow_in_arrival_order) {
+    event_queue_t queue;
+    queue.push("", 1.0, make_load("a", 0, 30), false);
+    queue.push("", 1.0, make_load("b", 1, 10), false);
+    queue.push("", 1.0, make_load("c", 2, 20), false);
+
+    EXPECT_EQ(3, queue.size());
+    EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), drain(queue));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(event_queue, serves_single_flow_in_deadline_order) {
+    event_queue_t queue;
+    queue.push("", 1.0, make_load("a", 0, 30), true);
+    queue.push("", 1.0, make_load("b", 1, 10), true);
+    queue.push("", 1.0, make_load("c", 2, 20), true);
+    queue.push("", 1.0, make_load("d", 3, 10), true);
+
+    EXPECT_EQ((std::vector<std::string>{"b", "d", "c", "a"}), drain(queue));
+}
+
+TEST(event_queue, front_is_stable_until_popped) {
+    event_queue_t queue;
+    queue.push("x", 1.0, make_load("a", 0, 10), false);
+    queue.push("y", 1.0, make_load("b", 0, 10), false);
+
+    const auto name = queue.front().event.name;
+    EXPECT_EQ(name, queue.front().event.name);
+    EXPECT_EQ(name, queue.front().event.name);
+}
+
+TEST(event_queue, shares_by_weight) {
+    event_queue_t queue;
+    for (int i = 0; i < 100; ++i) {
+        queue.push("heavy", 2.0, make_load("heavy", i, 100), false);
+        queue.push("light", 1.0, make_load("light", i, 100), false);
+    }
+
+    std::size_t heavy = 0;
+    for (int i = 0; i < 60; ++i) {
+        if (queue.front().event.name == "heavy") {
+            ++heavy;
+        }
+        queue.pop();
+    }
+
+    EXPECT_EQ(40, heavy);
+}
+
+TEST(event_queue, evicts_from_longest_flow) {
+    event_queue_t queue;
+    queue.push("x", 1.0, make_load("x1", 0, 10), false);
+    queue.push("x", 1.0, make_load("x2", 1, 10), false);
+    queue.push("x", 1.0, make_load("x3", 2, 10), false);
+    queue.push("y", 1.0, make_load("y1", 3, 10), false);
+
+    const auto evicted = queue.evict("y");
+    ASSERT_TRUE(evicted);
+    EXPECT_EQ("x3", evicted->event.name);
+    EXPECT_EQ(3, queue.size());
+
+    // Flows which differ by a single load are considered balanced.
+    queue.push("y", 1.0, make_load("y2", 4, 10), false);
+    EXPECT_FALSE(queue.evict("y"));
+    EXPECT_FALSE(queue.evict("x"));
+}
+
+TEST(event_queue, expires_overdue_loads) {
+    event_queue_t queue;
+    queue.push("x", 1.0, make_load("a", 0, 10), false);
+    queue.push("x", 1.0, make_load("b", 1, 30), false);
+    queue.push("y", 1.0, make_load("c", 2, 5), false);
+    queue.push("y", 1.0, make_load("d", 3, 40), false);
+
+    const auto expired = queue.expire(at(20));
+    ASSERT_EQ(2, expired.size());
+    EXPECT_EQ(2, queue.size());
+
+    std::vector<std::string> remaining = drain(queue);
+    std::sort(remaining.begin(), remaining.end());
+    EXPECT_EQ((std::vector<std::string>{"b", "d"}), remaining);
+}
+
+TEST(event_queue, tracks_oldest_birthstamp) {
+    event_queue_t queue;
+    EXPECT_FALSE(queue.oldest());
+
+    queue.push("x", 1.0, make_load("a", 5, 100), false);
+    queue.push("y", 1.0, make_load("b", 3, 10), false);
+    queue.push("x", 1.0, make_load("c", 7, 100), false);
+    queue.push("x", 1.0, make_load("d", 8, 100), false);
+    ASSERT_TRUE(queue.oldest());
+    EXPECT_EQ(at(3), *queue.oldest());
+
+    queue.expire(at(50));
+    EXPECT_EQ(at(5), *queue.oldest());
+
+    ASSERT_TRUE(queue.evict("y"));
+    EXPECT_EQ(at(5), *queue.oldest());
+
+    queue.pop();
+    EXPECT_EQ(at(7), *queue.oldest());
+
+    queue.pop();
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.oldest());
+}
+
+}  // namespace testing
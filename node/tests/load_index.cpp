@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "node/load_index.hpp"
+
+namespace testing {
+
+using cocaine::detail::service::node::load_index_t;
+
+TEST(load_index, selects_nothing_when_empty) {
+    load_index_t index;
+
+    EXPECT_EQ(nullptr, index.select(100));
+    EXPECT_EQ(0, index.pressure());
+    EXPECT_EQ(0, index.active());
+}
+
+TEST(load_index, selects_active_only) {
+    load_index_t index;
+    index.insert("a");
+    index.insert("b");
+    index.load("a", 3);
+    index.load("b", 1);
+
+    EXPECT_EQ(nullptr, index.select(100));
+
+    index.activity("a", true);
+    ASSERT_NE(nullptr, index.select(100));
+    EXPECT_EQ("a", *index.select(100));
+
+    index.activity("b", true);
+    ASSERT_NE(nullptr, index.select(100));
+    EXPECT_EQ("b", *index.select(100));
+
+    index.activity("b", false);
+    ASSERT_NE(nullptr, index.select(100));
+    EXPECT_EQ("a", *index.select(100));
+}
+
+TEST(load_index, selects_below_limit) {
+    load_index_t index;
+    index.insert("a");
+    index.activity("a", true);
+    index.load("a", 2);
+
+    EXPECT_EQ(nullptr, index.select(2));
+    ASSERT_NE(nullptr, index.select(3));
+    EXPECT_EQ("a", *index.select(3));
+}
+
+TEST(load_index, tracks_pressure_of_inactive_slaves) {
+    load_index_t index;
+    index.insert("a");
+    index.insert("b");
+    index.activity("a", true);
+    index.load("a", 2);
+    index.load("b", 5);
+
+    EXPECT_EQ(7, index.pressure());
+    EXPECT_EQ(1, index.active());
+
+    index.erase("b");
+    EXPECT_EQ(2, index.pressure());
+
+    index.clear();
+    EXPECT_EQ(0, index.pressure());
+    EXPECT_EQ(0, index.active());
+}
+
+TEST(load_index, ignores_unknown_slaves) {
+    load_index_t index;
+    index.load("a", 1);
+    index.activity("a", true);
+    index.erase("a");
+
+    EXPECT_EQ(nullptr, index.select(100));
+    EXPECT_EQ(0, index.pressure());
+}
+
+TEST(load_index, matches_linear_scan) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> slaves(0, 15);
+    std::uniform_int_distribution<int> action(0, 9);
+    std::uniform_int_distribution<std::uint64_t> loads(0, 20);
+
+    struct entry_t {
+        std::uint64_t load;
+        bool active;
+    };
+
+    load_index_t index;
+    std::map<std::string, entry_t> expected;
+
+    for (int i = 0; i < 10000; ++i) {
+        const auto id = std::to_string(slaves(random));
+
+        switch (action(random)) {
+        case 0:
+            index.erase(id);
+            expected.erase(id);
+            break;
+        case 1:
+        case 2:
+            if (expected.count(id) == 0) {
+                index.insert(id);
+                expected[id] = entry_t{0, false};
+            }
+            break;
+        case 3:
+        case 4:
+            index.activity(id, expected.count(id) == 0 || !expected[id].active);
+            if (expected.count(id) > 0) {
+                expected[id].active = !expected[id].active;
+            }
+            break;
+        default: {
+            const auto load = loads(random);
+            index.load(id, load);
+            if (expected.count(id) > 0) {
+                expected[id].load = load;
+            }
+        }
+        }
+
+        std::uint64_t pressure = 0;
+        std::size_t active = 0;
+        auto min = static_cast<std::uint64_t>(-1);
+        for (const auto& it : expected) {
+            pressure += it.second.load;
+            if (it.second.active) {
+                ++active;
+                min = std::min(min, it.second.load);
+            }
+        }
+
+        ASSERT_EQ(pressure, index.pressure());
+        ASSERT_EQ(active, index.active());
+
+        const auto selected = index.select(15);
+        if (min < 15) {
+            ASSERT_NE(nullptr, selected);
+            ASSERT_TRUE(expected.at(*selected).active);
+            ASSERT_EQ(min, expected.at(*selected).load);
+        } else {
+            ASSERT_EQ(nullptr, selected);
+        }
+    }
+}
+
+}  // namespace testing
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <asio/io_service.hpp>
+
+#include <cocaine/hpack/header.hpp>
+
+#include <gtest/gtest.h>
+
+#include "cocaine/api/stream.hpp"
+#include "cocaine/service/node/slave/error.hpp"
+
+#include "cocaine/detail/service/node/dispatch/client.hpp"
+#include "cocaine/detail/service/node/dispatch/worker.hpp"
+#include "cocaine/detail/service/node/slave/channel.hpp"
+#include "cocaine/detail/service/node/slave/timeout.hpp"
+
+namespace testing {
+
+using cocaine::detail::service::node::slave::channel_t;
+using cocaine::detail::service::node::slave::timeout_wheel_t;
+
+namespace {
+
+/// Client stream, which records the errors it has been aborted with.
+struct recorder_t : public cocaine::api::stream_t {
+    std::vector<std::error_code> errors;
+
+    auto write(cocaine::hpack::headers_t, const std::string&) -> recorder_t& override {
+        return *this;
+    }
+
+    auto error(cocaine::hpack::headers_t, const std::error_code& ec, const std::string&) -> void override {
+        errors.push_back(ec);
+    }
+
+    auto close(cocaine::hpack::headers_t) -> void override {}
+};
+
+struct fixture_t {
+    asio::io_service loop;
+    std::shared_ptr<timeout_wheel_t> wheel;
+    std::shared_ptr<recorder_t> stream;
+    std::shared_ptr<channel_t> channel;
+
+    explicit fixture_t(std::size_t slots) :
+        wheel(std::make_shared<timeout_wheel_t>(loop, std::chrono::milliseconds(10), slots)),
+        stream(std::make_shared<recorder_t>()),
+        channel(std::make_shared<channel_t>(1, std::chrono::high_resolution_clock::now(), nullptr,
+            [](std::uint64_t) {}))
+    {
+        channel->into_worker = std::make_shared<cocaine::client_rpc_dispatch_t>("app");
+        channel->from_worker = std::make_shared<cocaine::worker_rpc_dispatch_t>(stream,
+            [](const std::error_code&) {});
+    }
+
+    /// Runs the loop until the wheel stops ticking, returning the elapsed time.
+    auto run() -> std::chrono::milliseconds {
+        const auto started = std::chrono::steady_clock::now();
+        loop.run();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started);
+    }
+};
+
+}  // namespace
+
+TEST(timeout_wheel, expires_channel) {
+    fixture_t fixture(8);
+    fixture.wheel->schedule(*fixture.channel, std::chrono::milliseconds(25));
+
+    EXPECT_GE(fixture.run().count(), 25);
+    ASSERT_EQ(1, fixture.stream->errors.size());
+    EXPECT_EQ(std::error_code(cocaine::error::timeout_error), fixture.stream->errors.front());
+}
+
+TEST(timeout_wheel, expires_channel_after_several_rounds) {
+    // The wheel spans 40ms, so the channel has to survive several visits of its slot.
+    fixture_t fixture(4);
+    fixture.wheel->schedule(*fixture.channel, std::chrono::milliseconds(100));
+
+    EXPECT_GE(fixture.run().count(), 100);
+    EXPECT_EQ(1, fixture.stream->errors.size());
+}
+
+TEST(timeout_wheel, ignores_cancelled_channel) {
+    fixture_t fixture(8);
+    fixture.wheel->schedule(*fixture.channel, std::chrono::milliseconds(25));
+    fixture.wheel->cancel(*fixture.channel);
+
+    fixture.run();
+    EXPECT_TRUE(fixture.stream->errors.empty());
+
+    // Cancelling an untracked channel does nothing.
+    fixture.wheel->cancel(*fixture.channel);
+}
+
+TEST(timeout_wheel, reschedules_cancelled_channel) {
+    fixture_t fixture(8);
+    fixture.wheel->schedule(*fixture.channel, std::chrono::milliseconds(100));
+    fixture.wheel->cancel(*fixture.channel);
+    fixture.wheel->schedule(*fixture.channel, std::chrono::milliseconds(10));
+
+    EXPECT_LT(fixture.run().count(), 100);
+    EXPECT_EQ(1, fixture.stream->errors.size());
+}
+
+TEST(timeout_wheel, clear_stops_ticking) {
+    fixture_t fixture(8);
+    fixture.wheel->schedule(*fixture.channel, std::chrono::milliseconds(100));
+    fixture.wheel->clear();
+
+    EXPECT_LT(fixture.run().count(), 100);
+    EXPECT_TRUE(fixture.stream->errors.empty());
+}
+
+}  // namespace testing
@@ -8,6 +8,8 @@
 
 #include <asio/ip/tcp.hpp>
 
+#include <chrono>
+
 namespace cocaine {
 namespace api {
 namespace vicodyn {
@@ -34,6 +36,18 @@ public:
 
     virtual
     auto is_recoverable(const std::shared_ptr<cocaine::vicodyn::peer_t>& peer, std::error_code ec) -> bool = 0;
+
+    /// Called after the request has been sent to the peer. Every call is paired with `on_finish`.
+    virtual
+    auto on_start(const std::shared_ptr<cocaine::vicodyn::peer_t>& peer) -> void;
+
+    /// Called on the first response frame from the peer with the time elapsed since `on_start`.
+    virtual
+    auto on_response(const std::shared_ptr<cocaine::vicodyn::peer_t>& peer, std::chrono::microseconds elapsed) -> void;
+
+    /// Called when the peer is done with the request either way, including client disconnection.
+    virtual
+    auto on_finish(const std::shared_ptr<cocaine::vicodyn::peer_t>& peer) -> void;
 };
 
 } // namespace peer
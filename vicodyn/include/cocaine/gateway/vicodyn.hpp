@@ -77,6 +77,7 @@ private:
     api::gateway_ptr wrapped_gateway;
     vicodyn::peers_t peers;
     dynamic_t args;
+    std::shared_ptr<vicodyn::retry_budget_t> retry_budget;
     std::string local_uuid;
     std::unique_ptr<logging::logger_t> logger;
     synchronized<proxy_map_t> mapping;
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "cocaine/api/vicodyn/balancer.hpp"
+
+#include "cocaine/service/node/slave/error.hpp"
+#include "cocaine/vicodyn/request_context.hpp"
+
+#include <cocaine/errors.hpp>
+
+#include <blackhole/logger.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+namespace cocaine {
+namespace vicodyn {
+namespace balancer {
+
+/// Power of two choices balancer.
+///
+/// Picks two random eligible peers and sends the request to the one with the lower cost, which is
+/// the peak EWMA of response latency multiplied by the number of outstanding requests. Latency is
+/// sampled on the first response frame, errors are accounted as samples of the configured penalty.
+class p2c_t: public api::vicodyn::balancer_t {
+public:
+    /// Load of a single peer, updated without locking.
+    class stats_t {
+        std::atomic<std::int64_t> outstanding;
+        std::atomic<double> latency;
+
+        /// Time of the last sample in microseconds of the steady clock, zero if never sampled.
+        std::atomic<std::int64_t> sampled;
+
+    public:
+        stats_t();
+
+        auto cost(std::chrono::microseconds initial) -> double;
+
+        auto start() -> void;
+
+        auto finish() -> void;
+
+        auto idle() const -> bool;
+
+        /// Updates the peak EWMA, where `decay` is the time constant of the exponential weighting.
+        ///
+        /// Concurrent samples may shorten the decay interval of each other, which is negligible.
+        auto sample(std::chrono::microseconds elapsed, std::chrono::microseconds decay) -> void;
+    };
+
+    using stats_map_t = std::unordered_map<std::string, std::shared_ptr<stats_t>>;
+
+private:
+    peers_t& peers;
+    std::unique_ptr<logging::logger_t> logger;
+    size_t _retry_count;
+    std::string app_name;
+    std::string x_cocaine_cluster;
+    std::shared_ptr<const peers_t::index_t> index;
+
+    std::chrono::microseconds decay;
+    std::chrono::microseconds initial_latency;
+    std::chrono::microseconds error_penalty;
+
+    /// Statistics by peer uuid.
+    ///
+    /// The map is immutable and is replaced as a whole when a peer appears, so the request path only
+    /// takes the current snapshot. Idle entries of peers which are no longer eligible are dropped
+    /// while copying. Writers are serialized by the mutex.
+    std::shared_ptr<const stats_map_t> stats;
+    std::mutex mutex;
+
+public:
+    p2c_t(context_t& ctx, peers_t& peers, asio::io_service& loop, const std::string& app_name, const dynamic_t& args,
+          const dynamic_t::object_t& locator_extra);
+
+    auto choose_peer(const std::shared_ptr<request_context_t>& request_context, const hpack::headers_t& headers,
+                     const std::string& event) -> std::shared_ptr<cocaine::vicodyn::peer_t> override;
+
+    auto retry_count() -> size_t override;
+
+    auto on_error(const std::shared_ptr<peer_t>&, std::error_code, const std::string&) -> void override;
+
+    auto is_recoverable(const std::shared_ptr<peer_t>&, std::error_code ec) -> bool override;
+
+    auto on_start(const std::shared_ptr<peer_t>& peer) -> void override;
+
+    auto on_response(const std::shared_ptr<peer_t>& peer, std::chrono::microseconds elapsed) -> void override;
+
+    auto on_finish(const std::shared_ptr<peer_t>& peer) -> void override;
+
+private:
+    /// Returns statistics of the peer, null if there are none yet.
+    auto find(const std::string& uuid) const -> std::shared_ptr<stats_t>;
+
+    /// Returns statistics of the peer, creating them if needed.
+    auto stats_of(const std::string& uuid) -> std::shared_ptr<stats_t>;
+};
+
+} // namespace balancer
+} // namespace vicodyn
+} // namespace cocaine
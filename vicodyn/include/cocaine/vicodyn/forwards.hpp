@@ -36,6 +36,7 @@ namespace vicodyn {
 class invocation_t;
 class proxy_t;
 class peer_t;
+class retry_budget_t;
 
 } // namespace vicodyn
 } // namespace cocaine
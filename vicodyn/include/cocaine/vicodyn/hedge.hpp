@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cocaine/dynamic.hpp>
+#include <cocaine/locked_ptr.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace cocaine {
+namespace vicodyn {
+
+/// Hedging policy of an app proxy.
+///
+/// Requests of the listed (idempotent) events which have not got any response within the delay are
+/// duplicated to another peer. The delay is the configured percentile of recent response latencies
+/// clamped to the configured bounds. Each eligible request earns `ratio` of a hedge, so hedges never
+/// exceed the given fraction of traffic, except for bursts of up to `burst` hedges.
+///
+/// The attempt which loses the race is not cancelled, as the request has already been sent to the
+/// worker completely, so it runs to completion and hedges spend worker capacity accordingly.
+///
+/// Configured with the `hedging` object of the gateway args, keyed by app name:
+///     {"events": ["read"], "percentile": 95, "min_delay_ms": 5, "max_delay_ms": 1000, "ratio": 0.1, "burst": 10}
+class hedge_policy_t {
+    std::set<std::string> events;
+    double percentile;
+    std::chrono::microseconds min_delay;
+    std::chrono::microseconds max_delay;
+    double ratio;
+    double burst;
+
+    struct state_t {
+        /// Ring of recent response latencies in microseconds.
+        std::vector<std::int64_t> samples;
+        std::size_t cursor;
+        std::size_t since_update;
+        std::chrono::microseconds delay;
+        double tokens;
+    };
+
+    synchronized<state_t> state;
+
+    struct {
+        std::atomic<std::uint64_t> eligible;
+        std::atomic<std::uint64_t> sent;
+        std::atomic<std::uint64_t> won;
+        std::atomic<std::uint64_t> throttled;
+    } counters;
+
+public:
+    explicit
+    hedge_policy_t(const dynamic_t& args);
+
+    auto enabled(const std::string& event) const -> bool;
+
+    /// Accounts a request eligible for hedging.
+    auto admit() -> void;
+
+    auto delay() -> std::chrono::microseconds;
+
+    /// Records the time until the first successful response of a hedgeable request.
+    auto sample(std::chrono::microseconds elapsed) -> void;
+
+    /// Takes a hedge from the budget, returns false accounting the request as throttled if it is
+    /// exhausted.
+    auto acquire() -> bool;
+
+    /// Returns an acquired hedge, which could not be sent, to the budget.
+    auto refund() -> void;
+
+    /// Accounts a hedge which has been sent.
+    auto sent() -> void;
+
+    /// Accounts a hedge which has responded before the original request.
+    auto won() -> void;
+
+    auto info() -> dynamic_t;
+
+private:
+    auto update(state_t& state) -> void;
+};
+
+} // namespace vicodyn
+} // namespace cocaine
@@ -13,6 +13,8 @@
 
 #include <asio/ip/tcp.hpp>
 
+#include <atomic>
+#include <functional>
 #include <future>
 
 namespace cocaine {
@@ -24,27 +26,51 @@ public:
 
     using endpoints_t = std::vector<asio::ip::tcp::endpoint>;
 
+    /// Invoked on the peer loop after the session has been established or dropped.
+    using state_observer_t = std::function<void(const std::string& uuid)>;
+
+    /// Session a stream has been opened on, which is to be reconnected if the stream fails.
+    struct origin_t {
+        std::size_t slot;
+        std::weak_ptr<cocaine::session_t> session;
+    };
+
     ~peer_t();
 
-    peer_t(context_t& context, asio::io_service& loop, endpoints_t endpoints, std::string uuid, dynamic_t::object_t extra);
+    /// \param sessions number of connections to the peer, streams are spread over them round-robin.
+    peer_t(context_t& context, asio::io_service& loop, endpoints_t endpoints, std::string uuid, dynamic_t::object_t extra,
+           std::size_t sessions = 1, state_observer_t on_state_change = nullptr);
 
+    /// Opens a stream on one of the sessions, which is stored into `origin`. The session is
+    /// reconnected if it is missing or fails to open the stream.
     template<class Event, class ...Args>
-    auto open_stream(std::shared_ptr<io::basic_dispatch_t> dispatch, Args&& ...args) -> io::upstream_ptr_t {
-        auto locked = session.synchronize();
+    auto open_stream(origin_t& origin, std::shared_ptr<io::basic_dispatch_t> dispatch, Args&& ...args)
+        -> io::upstream_ptr_t
+    {
+        const auto index = choose_slot();
+        auto& slot = *slots[index];
+        auto locked = slot.session.synchronize();
         auto session = *locked;
         if(!session) {
-            schedule_reconnect(session);
+            schedule_reconnect(slot, *locked);
             throw error_t(error::not_connected, "session is not connected");
         }
-        d.last_active = std::chrono::system_clock::now();
-        auto stream = session->fork(std::move(dispatch));
-        stream->send<Event>(std::forward<Args>(args)...);
-        return stream;
+        origin = origin_t{index, session};
+        active.store(std::chrono::system_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        try {
+            auto stream = session->fork(std::move(dispatch));
+            stream->send<Event>(std::forward<Args>(args)...);
+            return stream;
+        } catch(const std::system_error&) {
+            schedule_reconnect(slot, *locked);
+            throw;
+        }
     }
 
     auto connect() -> void;
 
-    auto schedule_reconnect() -> void;
+    /// Reconnects the session a failed stream has been opened on, unless it is already replaced.
+    auto schedule_reconnect(const origin_t& origin) -> void;
 
     auto uuid() const -> const std::string&;
 
@@ -52,6 +78,9 @@ public:
 
     auto connected() const -> bool;
 
+    /// Number of currently established sessions.
+    auto connected_sessions() const -> std::size_t;
+
     auto last_active() const -> std::chrono::system_clock::time_point;
 
     auto extra() const -> const dynamic_t::object_t&;
@@ -59,20 +88,43 @@ public:
     auto x_cocaine_cluster() const -> const std::string&;
 
 private:
-    auto schedule_reconnect(std::shared_ptr<cocaine::session_t>& session) -> void;
+    /// One of the connections to the peer, which is reconnected independently of the others.
+    struct slot_t {
+        explicit
+        slot_t(asio::io_service& loop);
+
+        synchronized<std::shared_ptr<cocaine::session_t>> session;
+
+        /// Mirrors whether the session is set, allowing to skip disconnected slots without locking.
+        std::atomic<bool> established;
+
+        asio::deadline_timer timer;
+        bool connecting;
+    };
+
+    /// Returns the index of the slot to open the next stream on.
+    auto choose_slot() -> std::size_t;
+
+    auto connect(slot_t& slot) -> void;
+
+    auto schedule_reconnect(slot_t& slot, std::shared_ptr<cocaine::session_t>& session) -> void;
+
+    auto notify_state_change() -> void;
 
     context_t& context;
     std::string service_name;
     asio::io_service& loop;
-    asio::deadline_timer timer;
     std::unique_ptr<logging::logger_t> logger;
-    synchronized<std::shared_ptr<cocaine::session_t>> session;
-    bool connecting;
+    std::vector<std::unique_ptr<slot_t>> slots;
+    std::atomic<std::size_t> cursor;
+    state_observer_t on_state_change;
+
+    /// Time of the last activity in system clock ticks, updated by concurrent streams.
+    std::atomic<std::chrono::system_clock::rep> active;
 
     struct {
         std::string uuid;
         std::vector<asio::ip::tcp::endpoint> endpoints;
-        std::chrono::system_clock::time_point last_active;
         dynamic_t::object_t extra;
         std::string x_cocaine_cluster;
     } d;
@@ -91,12 +143,35 @@ public:
         app_data_t apps;
     };
 
+    using eligible_t = std::vector<std::shared_ptr<peer_t>>;
+
+    /// Connected peers serving an app within a cluster.
+    ///
+    /// The list is immutable and is replaced as a whole whenever peers, apps or connection states
+    /// change, so readers only take the current snapshot without touching the peers lock.
+    class index_t {
+        friend class peers_t;
+
+        std::string app;
+        std::string cluster;
+        std::shared_ptr<const eligible_t> snapshot;
+
+    public:
+        index_t(std::string app, std::string cluster);
+
+        auto peers() const -> std::shared_ptr<const eligible_t>;
+
+    private:
+        auto publish(std::shared_ptr<const eligible_t> peers) -> void;
+    };
 
 private:
     context_t& context;
     std::unique_ptr<logging::logger_t> logger;
     executor::owning_asio_t executor;
+    std::size_t sessions;
     data_t data;
+    std::map<std::pair<std::string, std::string>, std::shared_ptr<index_t>> indexes;
     mutable boost::shared_mutex mutex;
 
 
@@ -114,7 +189,11 @@ public:
     }
 
 
-    peers_t(context_t& context);
+    /// \param sessions number of connections to open to every registered peer.
+    peers_t(context_t& context, std::size_t sessions = 1);
+
+    /// Stops the executor before destroying peers, whose handlers and state observers run on it.
+    ~peers_t();
 
     auto register_peer(const std::string& uuid, const endpoints_t& endpoints, dynamic_t::object_t extra) -> std::shared_ptr<peer_t>;
 
@@ -129,6 +208,19 @@ public:
     auto erase(const std::string& uuid) -> void;
 
     auto peer(const std::string& uuid) -> std::shared_ptr<peer_t>;
+
+    /// Returns the index of peers eligible for the app in the cluster, which is kept up to date.
+    auto index(const std::string& app, const std::string& cluster) -> std::shared_ptr<const index_t>;
+
+private:
+    auto make_peer(const std::string& uuid, const endpoints_t& endpoints, dynamic_t::object_t extra)
+        -> std::shared_ptr<peer_t>;
+
+    auto rebuild_unsafe(index_t& index) -> void;
+
+    auto rebuild_app_unsafe(const std::string& app) -> void;
+
+    auto rebuild_peer_unsafe(const std::string& uuid) -> void;
 };
 
 } // namespace vicodyn
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cocaine/vicodyn/forwards.hpp"
+#include "cocaine/vicodyn/hedge.hpp"
 #include "cocaine/vicodyn/peer.hpp"
 
 #include <cocaine/api/service.hpp>
@@ -24,21 +25,26 @@ public:
 
     friend class vicodyn_dispatch_t;
 
-    proxy_t(context_t& context, asio::io_service& loop, peers_t& peers, const std::string& name,
-            const dynamic_t& args, const dynamic_t::object_t& extra);
+    proxy_t(context_t& context, asio::io_service& loop, peers_t& peers, std::shared_ptr<retry_budget_t> retry_budget,
+            const std::string& name, const dynamic_t& args, const dynamic_t::object_t& extra);
 
     auto empty() -> bool;
 
     auto size() -> size_t;
 
+    /// Hedging configuration and counters of the app.
+    auto hedging_info() -> dynamic_t;
+
 private:
     auto make_balancer(const dynamic_t& args, const dynamic_t::object_t& extra) -> api::vicodyn::balancer_ptr;
 
     context_t& context;
     asio::io_service& loop;
     peers_t& peers;
+    std::shared_ptr<retry_budget_t> retry_budget;
     std::string app_name;
     api::vicodyn::balancer_ptr balancer;
+    hedge_policy_t hedging;
 
     const std::unique_ptr<logging::logger_t> logger;
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "cocaine/vicodyn/forwards.hpp"
+
+#include <cocaine/dynamic.hpp>
+#include <cocaine/forwards.hpp>
+#include <cocaine/hpack/header.hpp>
+
+#include <metrics/metric.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cocaine {
+namespace vicodyn {
+
+/// Memory budget for buffering forward chunks of requests which may be retried.
+///
+/// Shared by all proxies of a gateway. Configured with the `retry_buffer` object of the gateway
+/// args, where `request_limit` and `global_limit` are the limits in bytes.
+class retry_budget_t {
+public:
+    using counter_t = metrics::shared_metric<std::atomic<std::int64_t>>;
+
+private:
+    std::size_t request_limit;
+    std::size_t global_limit;
+    std::atomic<std::size_t> used;
+
+    struct {
+        /// Number of bytes currently buffered.
+        counter_t buffered;
+
+        /// Number of requests which became non-retryable because of the budget.
+        counter_t overflows;
+    } stats;
+
+public:
+    retry_budget_t(context_t& context, const dynamic_t& args);
+
+    auto limit() const -> std::size_t;
+
+    /// Reserves the given number of bytes from the global budget, returns false if exceeded.
+    auto acquire(std::size_t size) -> bool;
+
+    auto release(std::size_t size) -> void;
+
+    auto overflow() -> void;
+};
+
+/// Forward chunks of a single request kept for replaying on retries.
+///
+/// Chunk data is shared rather than copied, so it can be sent to several peers while buffered.
+class retry_buffer_t {
+public:
+    struct chunk_t {
+        hpack::headers_t headers;
+        std::shared_ptr<const std::string> data;
+    };
+
+private:
+    std::shared_ptr<retry_budget_t> budget;
+    std::vector<chunk_t> buffered;
+    std::size_t size;
+
+public:
+    explicit
+    retry_buffer_t(std::shared_ptr<retry_budget_t> budget);
+
+    retry_buffer_t(const retry_buffer_t&) = delete;
+    retry_buffer_t& operator=(const retry_buffer_t&) = delete;
+
+    ~retry_buffer_t();
+
+    /// Buffers the chunk, returns false leaving the buffer intact if the budget is exceeded.
+    auto push(const hpack::headers_t& headers, std::shared_ptr<const std::string> data) -> bool;
+
+    auto chunks() const -> const std::vector<chunk_t>&;
+
+    auto clear() -> void;
+};
+
+} // namespace vicodyn
+} // namespace cocaine
@@ -7,6 +7,12 @@ namespace vicodyn {
 balancer_t::balancer_t(context_t&, cocaine::vicodyn::peers_t&, asio::io_service&, const std::string&,
                        const dynamic_t&, const dynamic_t::object_t&) {}
 
+auto balancer_t::on_start(const std::shared_ptr<cocaine::vicodyn::peer_t>&) -> void {}
+
+auto balancer_t::on_response(const std::shared_ptr<cocaine::vicodyn::peer_t>&, std::chrono::microseconds) -> void {}
+
+auto balancer_t::on_finish(const std::shared_ptr<cocaine::vicodyn::peer_t>&) -> void {}
+
 } // namespace vicodyn
 } // namespace api
 } // namespace cocaine
@@ -3,6 +3,7 @@
 #include "../../node/include/cocaine/idl/node.hpp"
 
 #include "cocaine/vicodyn/proxy.hpp"
+#include "cocaine/vicodyn/retry_buffer.hpp"
 
 #include <cocaine/context.hpp>
 #include <cocaine/context/quote.hpp>
@@ -38,6 +39,7 @@ struct dynamic_constructor<vicodyn::peer_t> {
         dynamic_t::object_t data;
         data["extra"] = from.extra();
         data["connected"] = from.connected();
+        data["sessions"] = from.connected_sessions();
         data["endpoints"] = from.endpoints();
         data["last_active"] = std::chrono::system_clock::to_time_t(from.last_active());
         data["uuid"] = from.uuid();
@@ -85,8 +87,10 @@ vicodyn_t::vicodyn_t(context_t& _context, const std::string& _local_uuid, const
     context(_context),
     locator_extra(locator_extra),
     wrapped_gateway(),
-    peers(context),
+    peers(context, args.as_object().at("sessions_per_peer", 1u).as_uint()),
     args(args),
+    retry_budget(std::make_shared<vicodyn::retry_budget_t>(context,
+        args.as_object().at("retry_buffer", dynamic_t::empty_object))),
     local_uuid(_local_uuid),
     logger(context.log(format("gateway/{}", name)))
 {
@@ -132,6 +136,16 @@ vicodyn_t::vicodyn_t(context_t& _context, const std::string& _local_uuid, const
             result.as_object()["apps"] = data.apps;
             result.as_object()["peers"] = data.peers;
         });
+        dynamic_t::object_t hedging;
+        mapping.apply([&](proxy_map_t& mapping) {
+            for(auto& pair : mapping) {
+                auto info = pair.second.proxy.hedging_info();
+                if(!info.as_object().at("events").as_array().empty()) {
+                    hedging[pair.first] = std::move(info);
+                }
+            }
+        });
+        result.as_object()["hedging"] = hedging;
         return result;
     });
     COCAINE_LOG_INFO(logger, "created dispatch");
@@ -190,7 +204,8 @@ auto vicodyn_t::consume(const std::string& uuid,
             peers.register_app(uuid, name);
             auto it = mapping.find(name);
             if(it == mapping.end()) {
-                auto proxy = std::make_unique<vicodyn::proxy_t>(context, executor.asio(), peers, "virtual::" + name, args, locator_extra);
+                auto proxy = std::make_unique<vicodyn::proxy_t>(context, executor.asio(), peers, retry_budget, "virtual::" + name, args,
+                                                                  locator_extra);
                 auto& proxy_ref = *proxy;
                 auto actor = std::make_unique<tcp_actor_t>(context, std::move(proxy));
                 actor->run();
@@ -16,6 +16,7 @@
 
 #include "cocaine/api/vicodyn/balancer.hpp"
 #include "cocaine/gateway/vicodyn.hpp"
+#include "cocaine/vicodyn/balancer/p2c.hpp"
 #include "cocaine/vicodyn/balancer/simple.hpp"
 #include "cocaine/vicodyn/error.hpp"
 #include "cocaine/repository/vicodyn/balancer.hpp"
@@ -36,6 +37,7 @@ initialize(api::repository_t& repository) {
     cocaine::error::registrar::add(cocaine::vicodyn::vicodyn_category(), cocaine::vicodyn::vicodyn_category_id);
 
     repository.insert<vicodyn::balancer::simple_t>("simple");
+    repository.insert<vicodyn::balancer::p2c_t>("p2c");
     repository.insert<gateway::vicodyn_t>("vicodyn");
 }
 
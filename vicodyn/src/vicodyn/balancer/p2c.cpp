@@ -0,0 +1,195 @@
+#include "cocaine/vicodyn/balancer/p2c.hpp"
+
+#include <cocaine/context.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+namespace cocaine {
+namespace vicodyn {
+namespace balancer {
+
+namespace {
+
+auto milliseconds(const dynamic_t& args, const char* name, unsigned int def) -> std::chrono::microseconds {
+    return std::chrono::milliseconds(args.as_object().at(name, def).as_uint());
+}
+
+auto now() -> std::int64_t {
+    const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count();
+}
+
+} // namespace
+
+p2c_t::stats_t::stats_t() :
+    outstanding(0),
+    latency(0),
+    sampled(0)
+{}
+
+auto p2c_t::stats_t::cost(std::chrono::microseconds initial) -> double {
+    const double ewma = sampled.load(std::memory_order_relaxed) == 0 ?
+        initial.count() :
+        latency.load(std::memory_order_relaxed);
+    return (ewma + 1) * (outstanding.load(std::memory_order_relaxed) + 1);
+}
+
+auto p2c_t::stats_t::start() -> void {
+    outstanding.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto p2c_t::stats_t::finish() -> void {
+    // Never goes below zero, even if the start has been accounted to a dropped entry.
+    auto current = outstanding.load(std::memory_order_relaxed);
+    while(current > 0 && !outstanding.compare_exchange_weak(current, current - 1, std::memory_order_relaxed)) {
+    }
+}
+
+auto p2c_t::stats_t::idle() const -> bool {
+    return outstanding.load(std::memory_order_relaxed) == 0;
+}
+
+auto p2c_t::stats_t::sample(std::chrono::microseconds elapsed, std::chrono::microseconds decay) -> void {
+    const auto timestamp = now();
+    const auto previous = sampled.exchange(timestamp, std::memory_order_relaxed);
+    const double value = elapsed.count();
+
+    auto current = latency.load(std::memory_order_relaxed);
+    double next;
+    do {
+        if(previous == 0 || value > current) {
+            // Peak sensitive - a slowdown is taken at once, a recovery is smoothed over time.
+            next = value;
+        } else {
+            const auto dt = std::max<std::int64_t>(timestamp - previous, 0);
+            const auto weight = std::exp(-static_cast<double>(dt) / std::max<std::int64_t>(decay.count(), 1));
+            next = current * weight + value * (1 - weight);
+        }
+    } while(!latency.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+p2c_t::p2c_t(context_t& ctx, peers_t& peers, asio::io_service& loop, const std::string& app_name,
+             const dynamic_t& args, const dynamic_t::object_t& locator_extra) :
+    api::vicodyn::balancer_t(ctx, peers, loop, app_name, args, locator_extra),
+    peers(peers),
+    logger(ctx.log(format("balancer/p2c/{}", app_name))),
+    _retry_count(args.as_object().at("retry_count", 4u).as_uint()),
+    app_name(app_name),
+    x_cocaine_cluster(locator_extra.at("x-cocaine-cluster", "").as_string()),
+    index(peers.index(app_name, x_cocaine_cluster)),
+    decay(milliseconds(args, "decay_ms", 10000)),
+    initial_latency(milliseconds(args, "initial_latency_ms", 10)),
+    error_penalty(milliseconds(args, "error_penalty_ms", 1000)),
+    stats(std::make_shared<stats_map_t>())
+{
+    COCAINE_LOG_INFO(logger, "created p2c balancer for app {}", app_name);
+}
+
+auto p2c_t::choose_peer(const std::shared_ptr<request_context_t>& request_context, const hpack::headers_t& /*headers*/,
+                        const std::string& /*event*/) -> std::shared_ptr<cocaine::vicodyn::peer_t>
+{
+    auto eligible = index->peers();
+    const auto size = eligible->size();
+    if(size == 0) {
+        COCAINE_LOG_WARNING(logger, "no connected peers with app {} in cluster '{}'", app_name, x_cocaine_cluster);
+        throw error_t("no peers found");
+    }
+
+    const auto position = static_cast<size_t>(rand()) % size;
+    const auto& first = (*eligible)[position];
+    if(size == 1) {
+        return first;
+    }
+    // The second candidate is taken from the rest, so both are always distinct.
+    const auto& second = (*eligible)[(position + 1 + static_cast<size_t>(rand()) % (size - 1)) % size];
+
+    // Peers which have already failed this request are the last resort on retries.
+    auto cost = [&](const std::shared_ptr<peer_t>& peer) -> double {
+        const auto stats = find(peer->uuid());
+        // Unknown peers cost the same as idle ones which have never been sampled.
+        const auto load = stats ? stats->cost(initial_latency) : initial_latency.count() + 1.0;
+        return load * (request_context->peer_use_count(peer) + 1);
+    };
+    return cost(second) < cost(first) ? second : first;
+}
+
+auto p2c_t::retry_count() -> size_t {
+    return _retry_count;
+}
+
+auto p2c_t::on_error(const std::shared_ptr<peer_t>& peer, std::error_code ec, const std::string& msg) -> void {
+    COCAINE_LOG_WARNING(logger, "peer errored - {}({})", ec.message(), msg);
+    if(ec.category() == error::node_category() && ec.value() == error::node_errors::not_running) {
+        peers.erase_app(peer->uuid(), app_name);
+    }
+    // Errors usually come fast, so without a penalty a failing peer would look like the best one.
+    stats_of(peer->uuid())->sample(error_penalty, decay);
+}
+
+auto p2c_t::is_recoverable(const std::shared_ptr<peer_t>&, std::error_code ec) -> bool {
+    bool queue_is_full = (ec.category() == error::overseer_category() && ec.value() == error::queue_is_full);
+    bool unavailable = (ec.category() == error::node_category() && ec.value() == error::not_running);
+    bool disconnected = (ec.category() == error::dispatch_category() && ec.value() == error::not_connected);
+    return queue_is_full || unavailable || disconnected;
+}
+
+auto p2c_t::on_start(const std::shared_ptr<peer_t>& peer) -> void {
+    stats_of(peer->uuid())->start();
+}
+
+auto p2c_t::on_response(const std::shared_ptr<peer_t>& peer, std::chrono::microseconds elapsed) -> void {
+    stats_of(peer->uuid())->sample(elapsed, decay);
+}
+
+auto p2c_t::on_finish(const std::shared_ptr<peer_t>& peer) -> void {
+    // Statistics of peers with outstanding requests are never dropped, so they may be missing only
+    // if the start has been accounted to an entry dropped concurrently.
+    if(auto stats = find(peer->uuid())) {
+        stats->finish();
+    }
+}
+
+auto p2c_t::find(const std::string& uuid) const -> std::shared_ptr<stats_t> {
+    const auto map = std::atomic_load(&stats);
+    const auto it = map->find(uuid);
+    if(it == map->end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+auto p2c_t::stats_of(const std::string& uuid) -> std::shared_ptr<stats_t> {
+    if(auto result = find(uuid)) {
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto current = std::atomic_load(&stats);
+    auto it = current->find(uuid);
+    if(it != current->end()) {
+        return it->second;
+    }
+
+    std::set<std::string> eligible;
+    for(const auto& peer : *index->peers()) {
+        eligible.insert(peer->uuid());
+    }
+
+    auto updated = std::make_shared<stats_map_t>();
+    for(const auto& pair : *current) {
+        if(!pair.second->idle() || eligible.count(pair.first) > 0) {
+            updated->insert(pair);
+        }
+    }
+
+    auto result = std::make_shared<stats_t>();
+    updated->emplace(uuid, result);
+    std::atomic_store(&stats, std::shared_ptr<const stats_map_t>(std::move(updated)));
+    return result;
+}
+
+} // namespace balancer
+} // namespace vicodyn
+} // namespace cocaine
@@ -6,22 +6,6 @@ namespace cocaine {
 namespace vicodyn {
 namespace balancer {
 
-template<class Iterator, class Predicate>
-auto choose_random_if(Iterator begin, Iterator end, size_t size, Predicate p) -> Iterator {
-    std::vector<Iterator> chosen;
-    chosen.reserve(size);
-    while(begin != end) {
-        if(p(*begin)) {
-            chosen.push_back(begin);
-        }
-        begin++;
-    }
-    if(chosen.empty()) {
-        return end;
-    }
-    return chosen[rand() % chosen.size()];
-}
-
 simple_t::simple_t(context_t& ctx, peers_t& peers, asio::io_service& loop, const std::string& app_name,
                    const dynamic_t& args, const dynamic_t::object_t& locator_extra) :
     api::vicodyn::balancer_t(ctx, peers, loop, app_name, args, locator_extra),
@@ -30,7 +14,8 @@ simple_t::simple_t(context_t& ctx, peers_t& peers, asio::io_service& loop, const
     args(args),
     _retry_count(args.as_object().at("retry_count", 4u).as_uint()),
     app_name(app_name),
-    x_cocaine_cluster(locator_extra.at("x-cocaine-cluster", "").as_string())
+    x_cocaine_cluster(locator_extra.at("x-cocaine-cluster", "").as_string()),
+    index(peers.index(app_name, x_cocaine_cluster))
 {
     COCAINE_LOG_INFO(logger, "created simple balancer for app {}", app_name);
 }
@@ -38,30 +23,12 @@ simple_t::simple_t(context_t& ctx, peers_t& peers, asio::io_service& loop, const
 auto simple_t::choose_peer(const std::shared_ptr<request_context_t>& /*request_context*/, const hpack::headers_t& /*headers*/,
                            const std::string& /*event*/) -> std::shared_ptr<cocaine::vicodyn::peer_t>
 {
-    return peers.apply_shared([&](const peers_t::data_t& mapping) {
-        auto apps_it = mapping.apps.find(app_name);
-        if(apps_it == mapping.apps.end() || apps_it->second.empty()) {
-            COCAINE_LOG_WARNING(logger, "peer list for app {} is empty", app_name);
-            throw error_t("no peers found");
-        }
-        auto& apps = apps_it->second;
-        auto it = choose_random_if(mapping.peers.begin(), mapping.peers.end(), mapping.peers.size(),
-            [&](const peers_t::peers_data_t::value_type& pair) -> bool {
-                if(!pair.second->connected()) {
-                    return false;
-                }
-                if(x_cocaine_cluster != pair.second->x_cocaine_cluster()) {
-                    return false;
-                }
-                return apps.count(pair.second->uuid()) > 0;
-            }
-        );
-        if(it != mapping.peers.end()) {
-            return it->second;
-        }
-        COCAINE_LOG_WARNING(logger, "all peers do not have desired app");
+    auto eligible = index->peers();
+    if(eligible->empty()) {
+        COCAINE_LOG_WARNING(logger, "no connected peers with app {} in cluster '{}'", app_name, x_cocaine_cluster);
         throw error_t("no peers found");
-    });
+    }
+    return (*eligible)[static_cast<size_t>(rand()) % eligible->size()];
 }
 
 auto simple_t::retry_count() -> size_t {
@@ -0,0 +1,135 @@
+#include "cocaine/vicodyn/hedge.hpp"
+
+#include <algorithm>
+
+namespace cocaine {
+namespace vicodyn {
+
+namespace {
+
+/// Number of recent latencies the delay is computed from.
+const std::size_t window = 512;
+
+/// Number of samples between delay recalculations.
+const std::size_t update_period = 32;
+
+auto milliseconds(const dynamic_t::object_t& args, const char* name, unsigned int def) -> std::chrono::microseconds {
+    return std::chrono::milliseconds(args.at(name, def).as_uint());
+}
+
+} // namespace
+
+hedge_policy_t::hedge_policy_t(const dynamic_t& args) :
+    percentile(args.as_object().at("percentile", 95.0).to<double>()),
+    min_delay(milliseconds(args.as_object(), "min_delay_ms", 5)),
+    max_delay(milliseconds(args.as_object(), "max_delay_ms", 1000)),
+    ratio(args.as_object().at("ratio", 0.1).to<double>()),
+    burst(args.as_object().at("burst", 10.0).to<double>())
+{
+    for(const auto& event : args.as_object().at("events", dynamic_t::empty_array).as_array()) {
+        events.insert(event.as_string());
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    min_delay = std::min(min_delay, max_delay);
+
+    state.apply([&](state_t& state) {
+        state.samples.reserve(window);
+        state.cursor = 0;
+        state.since_update = 0;
+        // Be conservative until enough latencies are known.
+        state.delay = max_delay;
+        state.tokens = burst;
+    });
+
+    counters.eligible = 0;
+    counters.sent = 0;
+    counters.won = 0;
+    counters.throttled = 0;
+}
+
+auto hedge_policy_t::enabled(const std::string& event) const -> bool {
+    return events.count(event) > 0;
+}
+
+auto hedge_policy_t::admit() -> void {
+    counters.eligible.fetch_add(1);
+    state.apply([&](state_t& state) {
+        state.tokens = std::min(state.tokens + ratio, burst);
+    });
+}
+
+auto hedge_policy_t::delay() -> std::chrono::microseconds {
+    return state.apply([&](const state_t& state) {
+        return state.delay;
+    });
+}
+
+auto hedge_policy_t::sample(std::chrono::microseconds elapsed) -> void {
+    state.apply([&](state_t& state) {
+        if(state.samples.size() < window) {
+            state.samples.push_back(elapsed.count());
+        } else {
+            state.samples[state.cursor] = elapsed.count();
+        }
+        state.cursor = (state.cursor + 1) % window;
+
+        if(++state.since_update >= update_period) {
+            update(state);
+        }
+    });
+}
+
+auto hedge_policy_t::acquire() -> bool {
+    auto acquired = state.apply([&](state_t& state) {
+        if(state.tokens < 1.0) {
+            return false;
+        }
+        state.tokens -= 1.0;
+        return true;
+    });
+
+    if(!acquired) {
+        counters.throttled.fetch_add(1);
+    }
+    return acquired;
+}
+
+auto hedge_policy_t::refund() -> void {
+    state.apply([&](state_t& state) {
+        state.tokens = std::min(state.tokens + 1.0, burst);
+    });
+}
+
+auto hedge_policy_t::sent() -> void {
+    counters.sent.fetch_add(1);
+}
+
+auto hedge_policy_t::won() -> void {
+    counters.won.fetch_add(1);
+}
+
+auto hedge_policy_t::info() -> dynamic_t {
+    dynamic_t::object_t result;
+    result["events"] = dynamic_t::array_t(events.begin(), events.end());
+    result["delay_us"] = delay().count();
+    result["eligible"] = counters.eligible.load();
+    result["sent"] = counters.sent.load();
+    result["won"] = counters.won.load();
+    result["throttled"] = counters.throttled.load();
+    return result;
+}
+
+auto hedge_policy_t::update(state_t& state) -> void {
+    state.since_update = 0;
+
+    auto samples = state.samples;
+    auto position = static_cast<std::size_t>(percentile / 100.0 * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(position), samples.end());
+
+    std::chrono::microseconds delay(samples[position]);
+    state.delay = std::min(std::max(delay, min_delay), max_delay);
+}
+
+} // namespace vicodyn
+} // namespace cocaine
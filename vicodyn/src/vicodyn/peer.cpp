@@ -15,6 +15,8 @@
 #include <asio/ip/tcp.hpp>
 #include <asio/connect.hpp>
 
+#include <algorithm>
+
 #include <blackhole/logger.hpp>
 
 #include <metrics/registry.hpp>
@@ -24,33 +26,64 @@
 namespace cocaine {
 namespace vicodyn {
 
+peer_t::slot_t::slot_t(asio::io_service& loop) :
+    established(false),
+    timer(loop),
+    connecting(false)
+{}
+
 peer_t::~peer_t(){
-    session.apply([&](std::shared_ptr<session_t>& session) {
-        if(session) {
-            session->detach(std::error_code());
-        }
-    });
+    for(auto& slot : slots) {
+        slot->session.apply([&](std::shared_ptr<session_t>& session) {
+            if(session) {
+                session->detach(std::error_code());
+            }
+        });
+    }
 }
 
-peer_t::peer_t(context_t& context, asio::io_service& loop, endpoints_t endpoints, std::string uuid, dynamic_t::object_t extra) :
+peer_t::peer_t(context_t& context, asio::io_service& loop, endpoints_t endpoints, std::string uuid, dynamic_t::object_t extra,
+               std::size_t sessions, state_observer_t on_state_change) :
     context(context),
     loop(loop),
-    timer(loop),
     logger(context.log(format("vicodyn_peer/{}", uuid))),
-    connecting(),
-    d({std::move(uuid), std::move(endpoints), std::chrono::system_clock::now(), std::move(extra), {}})
+    cursor(0),
+    on_state_change(std::move(on_state_change)),
+    active(std::chrono::system_clock::now().time_since_epoch().count()),
+    d({std::move(uuid), std::move(endpoints), std::move(extra), {}})
 {
     d.x_cocaine_cluster = d.extra.at("x-cocaine-cluster", "").as_string();
+    for(std::size_t i = 0; i < std::max<std::size_t>(sessions, 1); ++i) {
+        slots.emplace_back(new slot_t(loop));
+    }
+}
+
+auto peer_t::choose_slot() -> std::size_t {
+    const auto start = cursor.fetch_add(1, std::memory_order_relaxed);
+    for(std::size_t i = 0; i < slots.size(); ++i) {
+        const auto index = (start + i) % slots.size();
+        if(slots[index]->established.load(std::memory_order_relaxed)) {
+            return index;
+        }
+    }
+    // Nothing is connected, the caller will fail and trigger reconnection of this one.
+    return start % slots.size();
 }
 
-auto peer_t::schedule_reconnect() -> void {
-    COCAINE_LOG_INFO(logger, "scheduling reconnection of peer {} to {}", uuid(), endpoints());
-    session.apply([&](std::shared_ptr<session_t>& session) {
-        schedule_reconnect(session);
+auto peer_t::schedule_reconnect(const origin_t& origin) -> void {
+    auto& slot = *slots.at(origin.slot);
+    slot.session.apply([&](std::shared_ptr<session_t>& session) {
+        if(session && session != origin.session.lock()) {
+            COCAINE_LOG_DEBUG(logger, "session {} of peer {} has already been reconnected", origin.slot, uuid());
+            return;
+        }
+        COCAINE_LOG_INFO(logger, "scheduling reconnection of session {} of peer {} to {}", origin.slot, uuid(), endpoints());
+        schedule_reconnect(slot, session);
     });
 }
-auto peer_t::schedule_reconnect(std::shared_ptr<cocaine::session_t>& session) -> void {
-    if(connecting) {
+
+auto peer_t::schedule_reconnect(slot_t& slot, std::shared_ptr<cocaine::session_t>& session) -> void {
+    if(slot.connecting) {
         COCAINE_LOG_INFO(logger, "reconnection is alredy in progress for {}", uuid());
         return;
     }
@@ -58,25 +91,40 @@ auto peer_t::schedule_reconnect(std::shared_ptr<cocaine::session_t>& session) ->
         // In fact it should be detached already
         session->detach(std::error_code());
         session = nullptr;
+        slot.established = false;
+        notify_state_change();
     }
-    timer.expires_from_now(boost::posix_time::seconds(1));
-    timer.async_wait([&](std::error_code ec) {
+    slot.timer.expires_from_now(boost::posix_time::seconds(1));
+    slot.timer.async_wait([this, &slot](std::error_code ec) {
         if(!ec) {
-            connect();
+            connect(slot);
         }
     });
-    connecting = true;
+    slot.connecting = true;
     COCAINE_LOG_INFO(logger, "scheduled reconnection of peer {} to {}", uuid(), endpoints());
 }
 
 auto peer_t::connect() -> void {
-    connecting = true;
+    for(auto& slot : slots) {
+        connect(*slot);
+    }
+}
+
+auto peer_t::connect(slot_t& slot) -> void {
+    slot.connecting = true;
     COCAINE_LOG_INFO(logger, "connecting peer {} to {}", uuid(), endpoints());
 
     auto socket = std::make_shared<asio::ip::tcp::socket>(loop);
     auto connect_timer = std::make_shared<asio::deadline_timer>(loop);
 
     std::weak_ptr<peer_t> weak_self(shared_from_this());
+    auto slot_ptr = &slot;
+
+    auto reconnect = [=]() {
+        slot_ptr->session.apply([&](std::shared_ptr<session_t>& session) {
+            schedule_reconnect(*slot_ptr, session);
+        });
+    };
 
     auto begin = d.endpoints.begin();
     auto end = d.endpoints.end();
@@ -90,8 +138,8 @@ auto peer_t::connect() -> void {
         if(!ec) {
             COCAINE_LOG_INFO(logger, "connection timer expired, canceling socket, going to schedule reconnect");
             socket->cancel();
-            self->connecting = false;
-            self->schedule_reconnect();
+            slot_ptr->connecting = false;
+            reconnect();
         } else {
             COCAINE_LOG_DEBUG(logger, "connection timer was cancelled");
         }
@@ -110,8 +158,8 @@ auto peer_t::connect() -> void {
         if(ec) {
             COCAINE_LOG_ERROR(logger, "could not connect to {} - {}({})", *endpoint_it, ec.message(), ec.value());
             if(endpoint_it == end) {
-                connecting = false;
-                schedule_reconnect();
+                slot_ptr->connecting = false;
+                reconnect();
             }
             return;
         }
@@ -119,14 +167,29 @@ auto peer_t::connect() -> void {
             COCAINE_LOG_INFO(logger, "suceesfully connected peer {} to {}", uuid(), endpoints());
             auto ptr = std::make_unique<asio::ip::tcp::socket>(std::move(*socket));
             auto new_session = context.engine().attach(std::move(ptr), nullptr);
-            session.apply([&](std::shared_ptr<session_t>& session) {
-                connecting = false;
+            slot_ptr->session.apply([&](std::shared_ptr<session_t>& session) {
+                slot_ptr->connecting = false;
                 session = std::move(new_session);
-                d.last_active = std::chrono::system_clock::now();
+                slot_ptr->established = true;
+                active.store(std::chrono::system_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
             });
+            notify_state_change();
         } catch(const std::exception& e) {
             COCAINE_LOG_WARNING(logger, "failed to attach session to queue: {}", e.what());
-            schedule_reconnect();
+            reconnect();
+        }
+    });
+}
+
+auto peer_t::notify_state_change() -> void {
+    if(!on_state_change) {
+        return;
+    }
+    // The observer inspects the session, which may be locked by the caller, so it is deferred.
+    std::weak_ptr<peer_t> weak_self(shared_from_this());
+    loop.post([=]() {
+        if(auto self = weak_self.lock()) {
+            self->on_state_change(self->uuid());
         }
     });
 }
@@ -140,13 +203,21 @@ auto peer_t::endpoints() const -> const std::vector<asio::ip::tcp::endpoint>& {
 }
 
 auto peer_t::connected() const -> bool {
-    return session.apply([&](const std::shared_ptr<session_t>& session){
-        return static_cast<bool>(session);
-    });
+    return connected_sessions() > 0;
+}
+
+auto peer_t::connected_sessions() const -> std::size_t {
+    std::size_t result = 0;
+    for(const auto& slot : slots) {
+        if(slot->established.load(std::memory_order_relaxed)) {
+            result++;
+        }
+    }
+    return result;
 }
 
 auto peer_t::last_active() const -> std::chrono::system_clock::time_point {
-    return d.last_active;
+    return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(active.load(std::memory_order_relaxed)));
 }
 
 auto peer_t::extra() const -> const dynamic_t::object_t& {
@@ -157,24 +228,60 @@ auto peer_t::x_cocaine_cluster() const -> const std::string& {
     return d.x_cocaine_cluster;
 }
 
-peers_t::peers_t(context_t& context):
+peers_t::index_t::index_t(std::string app, std::string cluster) :
+    app(std::move(app)),
+    cluster(std::move(cluster)),
+    snapshot(std::make_shared<eligible_t>())
+{}
+
+auto peers_t::index_t::peers() const -> std::shared_ptr<const eligible_t> {
+    return std::atomic_load(&snapshot);
+}
+
+auto peers_t::index_t::publish(std::shared_ptr<const eligible_t> peers) -> void {
+    std::atomic_store(&snapshot, std::move(peers));
+}
+
+peers_t::peers_t(context_t& context, std::size_t sessions):
     context(context),
-    logger(context.log("vicodyn/peers_t"))
+    logger(context.log("vicodyn/peers_t")),
+    sessions(sessions)
 {}
 
+peers_t::~peers_t() {
+    // Peer sockets and timers are bound to the executor loop, so it must outlive them, but none of
+    // their handlers may run while they are being destroyed. The loop is stopped from within itself
+    // to be sure the last handler has finished.
+    auto& loop = executor.asio();
+    std::promise<void> stopped;
+    loop.post([&]() {
+        loop.stop();
+        stopped.set_value();
+    });
+    stopped.get_future().wait();
+
+    for(auto& pair : indexes) {
+        pair.second->publish(std::make_shared<eligible_t>());
+    }
+    indexes.clear();
+    data.peers.clear();
+}
+
 auto peers_t::register_peer(const std::string& uuid, const endpoints_t& endpoints, dynamic_t::object_t extra)
     -> std::shared_ptr<peer_t>
 {
     return apply([&](data_t& data){
         auto& peer = data.peers[uuid];
         if(!peer) {
-            peer = std::make_shared<peer_t>(context, executor.asio(), endpoints, uuid, std::move(extra));
+            peer = make_peer(uuid, endpoints, std::move(extra));
             peer->connect();
+            rebuild_peer_unsafe(uuid);
         } else if (endpoints != peer->endpoints()) {
             COCAINE_LOG_ERROR(logger, "changed endpoints detected for uuid {}, previous {}, new {}", uuid,
                               peer->endpoints(), endpoints);
-            peer = std::make_shared<peer_t>(context, executor.asio(), endpoints, uuid, extra);
+            peer = make_peer(uuid, endpoints, extra);
             peer->connect();
+            rebuild_peer_unsafe(uuid);
         }
         return peer;
     });
@@ -183,24 +290,30 @@ auto peers_t::register_peer(const std::string& uuid, const endpoints_t& endpoint
 auto peers_t::register_peer(const std::string& uuid, std::shared_ptr<peer_t> peer) -> void {
     apply([&](data_t& data) {
         data.peers[uuid] = std::move(peer);
+        rebuild_peer_unsafe(uuid);
     });
 }
 
 auto peers_t::erase_peer(const std::string& uuid) -> void {
     apply([&](data_t& data){
         data.peers.erase(uuid);
+        rebuild_peer_unsafe(uuid);
     });
 }
 
 auto peers_t::register_app(const std::string& uuid, const std::string& name) -> void {
     apply([&](data_t& data) {
-        data.apps[name].insert(uuid);
+        if(data.apps[name].insert(uuid).second) {
+            rebuild_app_unsafe(name);
+        }
     });
 }
 
 auto peers_t::erase_app(const std::string& uuid, const std::string& name) -> void {
     apply([&](data_t& data) {
-        data.apps[name].erase(uuid);
+        if(data.apps[name].erase(uuid) > 0) {
+            rebuild_app_unsafe(name);
+        }
     });
 }
 
@@ -208,8 +321,10 @@ auto peers_t::erase(const std::string& uuid) -> void {
     erase_peer(uuid);
     apply([&](data_t& data) {
         data.peers.erase(uuid);
-        for(auto pair : data.apps) {
-            pair.second.erase(uuid);
+        for(auto& pair : data.apps) {
+            if(pair.second.erase(uuid) > 0) {
+                rebuild_app_unsafe(pair.first);
+            }
         }
     });
 }
@@ -224,5 +339,63 @@ auto peers_t::peer(const std::string& uuid) -> std::shared_ptr<peer_t> {
     });
 }
 
+auto peers_t::index(const std::string& app, const std::string& cluster) -> std::shared_ptr<const index_t> {
+    return apply([&](data_t&) -> std::shared_ptr<const index_t> {
+        auto& index = indexes[std::make_pair(app, cluster)];
+        if(!index) {
+            index = std::make_shared<index_t>(app, cluster);
+            rebuild_unsafe(*index);
+        }
+        return index;
+    });
+}
+
+auto peers_t::make_peer(const std::string& uuid, const endpoints_t& endpoints, dynamic_t::object_t extra)
+    -> std::shared_ptr<peer_t>
+{
+    return std::make_shared<peer_t>(context, executor.asio(), endpoints, uuid, std::move(extra), sessions,
+        [this](const std::string& uuid) {
+            apply([&](data_t&) {
+                rebuild_peer_unsafe(uuid);
+            });
+        }
+    );
+}
+
+auto peers_t::rebuild_unsafe(index_t& index) -> void {
+    auto eligible = std::make_shared<eligible_t>();
+    auto apps_it = data.apps.find(index.app);
+    if(apps_it != data.apps.end()) {
+        eligible->reserve(apps_it->second.size());
+        for(const auto& uuid : apps_it->second) {
+            auto it = data.peers.find(uuid);
+            if(it == data.peers.end()) {
+                continue;
+            }
+            const auto& peer = it->second;
+            if(peer->connected() && peer->x_cocaine_cluster() == index.cluster) {
+                eligible->push_back(peer);
+            }
+        }
+    }
+    index.publish(std::move(eligible));
+}
+
+auto peers_t::rebuild_app_unsafe(const std::string& app) -> void {
+    auto it = indexes.lower_bound(std::make_pair(app, std::string()));
+    for(; it != indexes.end() && it->first.first == app; ++it) {
+        rebuild_unsafe(*it->second);
+    }
+}
+
+auto peers_t::rebuild_peer_unsafe(const std::string& uuid) -> void {
+    for(const auto& pair : indexes) {
+        auto apps_it = data.apps.find(pair.first.first);
+        if(apps_it != data.apps.end() && apps_it->second.count(uuid) > 0) {
+            rebuild_unsafe(*pair.second);
+        }
+    }
+}
+
 } // namespace vicodyn
 } // namespace cocaine
@@ -7,6 +7,7 @@
 
 #include "cocaine/vicodyn/peer.hpp"
 #include "cocaine/vicodyn/request_context.hpp"
+#include "cocaine/vicodyn/retry_buffer.hpp"
 #include "cocaine/service/node/slave/error.hpp"
 
 #include <cocaine/context.hpp>
@@ -72,9 +73,9 @@ public:
         return stream.is_initialized();
     }
 
-    auto chunk(const hpack::headers_t& headers, std::string data) -> bool {
+    auto chunk(const hpack::headers_t& headers, const std::string& data) -> bool {
         if(!closed && stream) {
-            stream = stream->send<protocol::chunk>(headers, std::move(data));
+            stream = stream->send<protocol::chunk>(headers, data);
             return true;
         }
         return false;
@@ -106,21 +107,46 @@ class vicodyn_dispatch_t : public std::enable_shared_from_this<vicodyn_dispatch_
     std::shared_ptr<request_context_t> request_context;
     std::unique_ptr<logging::logger_t> logger;
     std::shared_ptr<peer_t> peer;
+    peer_t::origin_t origin;
     discardable<app_tag> forward_dispatch;
     discardable<app_tag> backward_dispatch;
+    discardable<app_tag> hedge_dispatch;
 
     safe_stream_t backward_stream;
     safe_stream_t forward_stream;
 
     std::string enqueue_frame;
     hpack::headers_t enqueue_headers;
-    std::vector<std::string> chunks;
-    std::vector<hpack::headers_t> chunk_headers;
+    retry_buffer_t retry_buffer;
     bool choke_sent;
     hpack::headers_t choke_headers;
 
     bool buffering_enabled;
 
+    /// Time of the first enqueue, hedging delays are based on the latency seen by the client.
+    std::chrono::steady_clock::time_point request_start;
+    bool request_sampled;
+
+    /// State of the current attempt, which is reported to the balancer.
+    std::chrono::steady_clock::time_point attempt_start;
+    bool attempt_active;
+    bool attempt_responded;
+
+    /// Duplicate of the request racing against the current attempt until either responds.
+    ///
+    /// Both attempts are served through their own backward dispatches, `swapped` tells whether the
+    /// current one is served through `hedge_dispatch` after the hedge has won.
+    struct {
+        std::shared_ptr<peer_t> peer;
+        peer_t::origin_t origin;
+        safe_stream_t forward_stream;
+        std::chrono::steady_clock::time_point start;
+    } hedge;
+    bool hedgeable;
+    bool hedging;
+    bool swapped;
+    asio::deadline_timer hedge_timer;
+
     synchronized<void> mutex;
 
 public:
@@ -178,7 +204,7 @@ public:
                 COCAINE_LOG_WARNING(parent->logger, "failed to send error to forward dispatch - {}", error::to_string(e));
                 parent->backward_stream.error({}, make_error_code(vicodyn_errors::failed_to_send_error_to_forward),
                                               "failed to send error to forward dispatch");
-                parent->peer->schedule_reconnect();
+                parent->peer->schedule_reconnect(parent->origin);
             }
         }
     };
@@ -189,11 +215,22 @@ public:
         request_context(std::move(req_ctx)),
         logger(new blackhole::wrapper_t(*proxy.logger, {{"peer", _peer->uuid()}})),
         peer(std::move(_peer)),
+        origin(),
         forward_dispatch(name + "/forward"),
         backward_dispatch(name + "/backward"),
+        hedge_dispatch(name + "/hedge"),
         backward_stream(std::move(b_stream)),
         forward_stream(),
-        buffering_enabled(true)
+        retry_buffer(proxy.retry_budget),
+        choke_sent(false),
+        buffering_enabled(true),
+        request_sampled(false),
+        attempt_active(false),
+        attempt_responded(false),
+        hedgeable(false),
+        hedging(false),
+        swapped(false),
+        hedge_timer(proxy.loop)
     {
         namespace ph = std::placeholders;
 
@@ -223,33 +260,42 @@ public:
         });
 
 
-        backward_dispatch.on<protocol::chunk>()
-            .execute(std::bind(&vicodyn_dispatch_t::on_backward_chunk, this, ph::_1, ph::_2));
+        for(auto second : {false, true}) {
+            auto& backward = second ? hedge_dispatch : backward_dispatch;
 
-        backward_dispatch.on<protocol::choke>()
-            .execute(std::bind(&vicodyn_dispatch_t::on_backward_choke, this, ph::_1));
+            backward.on<protocol::chunk>()
+                .execute(std::bind(&vicodyn_dispatch_t::on_backward_chunk, this, second, ph::_1, ph::_2));
 
-        backward_dispatch.on<protocol::error>()
-            .execute(std::bind(&vicodyn_dispatch_t::on_backward_error, this, ph::_1, ph::_2, ph::_3));
+            backward.on<protocol::choke>()
+                .execute(std::bind(&vicodyn_dispatch_t::on_backward_choke, this, second, ph::_1));
 
-        backward_dispatch.on_discard([&](const std::error_code& ec) {
-            try {
-                backward_stream.error({}, make_error_code(vicodyn_errors::upstream_disconnected),
-                                      "vicodyn upstream has been disconnected");
-            } catch (const std::exception& e) {
-                COCAINE_LOG_WARNING(logger, "could not send error {} to upstream - {}", ec, e);
-            }
-        });
+            backward.on<protocol::error>()
+                .execute(std::bind(&vicodyn_dispatch_t::on_backward_error, this, second, ph::_1, ph::_2, ph::_3));
+
+            backward.on_discard(std::bind(&vicodyn_dispatch_t::on_backward_discard, this, second, ph::_1));
+        }
     }
 
     ~vicodyn_dispatch_t() {
+        finish_attempt_unsafe();
+        if(hedging) {
+            proxy.balancer->on_finish(hedge.peer);
+        }
     }
 
     auto on_forward_chunk(const hpack::headers_t& headers, std::string chunk) -> void {
         COCAINE_LOG_DEBUG(logger, "processing chunk");
-        chunks.push_back(std::move(chunk));
-        chunk_headers.push_back(headers);
-        forward_stream.chunk(headers, chunks.back());
+        if(!buffering_enabled) {
+            forward_stream.chunk(headers, chunk);
+            request_context->add_checkpoint("after_fchunk");
+            return;
+        }
+        auto data = std::make_shared<const std::string>(std::move(chunk));
+        if(!retry_buffer.push(headers, data)) {
+            COCAINE_LOG_INFO(logger, "retry buffer budget exceeded, request is no longer retriable");
+            disable_buffering_unsafe();
+        }
+        forward_stream.chunk(headers, *data);
         request_context->add_checkpoint("after_fchunk");
     }
 
@@ -264,11 +310,21 @@ public:
     auto on_forward_error(const hpack::headers_t& headers, const std::error_code& ec, const std::string& msg) -> void {
         COCAINE_LOG_INFO(logger, "processing error");
         forward_stream.error(headers, ec, msg);
+        if(hedging) {
+            hedge.forward_stream.error(headers, ec, msg);
+        }
         request_context->add_checkpoint("after_ferror");
     }
 
-    auto on_backward_chunk(const hpack::headers_t& headers, std::string chunk) -> void {
-        disable_buffering();
+    auto on_backward_chunk(bool second, const hpack::headers_t& headers, std::string chunk) -> void {
+        {
+            auto guard = mutex.synchronize();
+            if(!accept_unsafe(second)) {
+                return;
+            }
+            respond_attempt_unsafe(true);
+            disable_buffering_unsafe();
+        }
         try {
             backward_stream.chunk(headers, std::move(chunk));
             request_context->add_checkpoint("after_bchunk");
@@ -277,8 +333,18 @@ public:
         }
     }
 
-    auto on_backward_error(const hpack::headers_t& headers, const std::error_code& ec, const std::string& msg) -> void {
+    auto on_backward_error(bool second, const hpack::headers_t& headers, const std::error_code& ec,
+                           const std::string& msg) -> void
+    {
         COCAINE_LOG_WARNING(logger, "received error from peer {}({}) - {}", ec.message(), ec.value(), msg);
+        {
+            auto guard = mutex.synchronize();
+            if(!accept_error_unsafe(second, ec, msg)) {
+                return;
+            }
+            respond_attempt_unsafe(false);
+            finish_attempt_unsafe();
+        }
         proxy.balancer->on_error(peer, ec, msg);
         if(proxy.balancer->is_recoverable(peer, ec)) {
             try {
@@ -301,7 +367,15 @@ public:
     };
 
 
-    auto on_backward_choke(const hpack::headers_t& headers) -> void {
+    auto on_backward_choke(bool second, const hpack::headers_t& headers) -> void {
+        {
+            auto guard = mutex.synchronize();
+            if(!accept_unsafe(second)) {
+                return;
+            }
+            respond_attempt_unsafe(true);
+            finish_attempt_unsafe();
+        }
         try {
             if(backward_stream.close(headers)) {
                 request_context->add_checkpoint("after_bchoke");
@@ -324,11 +398,39 @@ public:
         });
     }
 
+    auto on_backward_discard(bool second, const std::error_code& ec) -> void {
+        {
+            auto guard = mutex.synchronize();
+            if(!accept_error_unsafe(second, ec, "upstream has been disconnected")) {
+                return;
+            }
+            finish_attempt_unsafe();
+        }
+        try {
+            backward_stream.error({}, make_error_code(vicodyn_errors::upstream_disconnected),
+                                  "vicodyn upstream has been disconnected");
+        } catch (const std::exception& e) {
+            COCAINE_LOG_WARNING(logger, "could not send error {} to upstream - {}", ec, e);
+        }
+    }
+
+    auto on_hedge_timer() -> void {
+        mutex.apply([&](){
+            hedge_unsafe();
+        });
+    }
+
+    /// Must not be called under the lock, which is the case for the backward handlers as they
+    /// release it before sending to the client.
     auto on_client_disconnection() -> void {
-        // TODO: Do we need lock here?
-        COCAINE_LOG_DEBUG(logger, "sending discard frame");
-        auto ec = make_error_code(error::dispatch_errors::not_connected);
-        forward_stream.error({}, ec, "vicodyn client was disconnected");
+        mutex.apply([&](){
+            COCAINE_LOG_DEBUG(logger, "sending discard frame");
+            auto ec = make_error_code(error::dispatch_errors::not_connected);
+            forward_stream.error({}, ec, "vicodyn client was disconnected");
+            if(hedging) {
+                hedge.forward_stream.error({}, ec, "vicodyn client was disconnected");
+            }
+        });
     }
 
     auto enqueue(const hpack::headers_t& headers, std::string event) -> void {
@@ -346,7 +448,11 @@ public:
     }
 
     auto shared_backward_dispatch() -> std::shared_ptr<dispatch<app_tag>> {
-        return std::shared_ptr<dispatch<app_tag>>(shared_from_this(), &backward_dispatch);
+        return std::shared_ptr<dispatch<app_tag>>(shared_from_this(), swapped ? &hedge_dispatch : &backward_dispatch);
+    }
+
+    auto shared_hedge_dispatch() -> std::shared_ptr<dispatch<app_tag>> {
+        return std::shared_ptr<dispatch<app_tag>>(shared_from_this(), swapped ? &backward_dispatch : &hedge_dispatch);
     }
 
     auto shared_forward_dispatch() -> std::shared_ptr<dispatch<app_tag>> {
@@ -354,12 +460,166 @@ public:
     }
 
 private:
+    auto start_attempt_unsafe() -> void {
+        attempt_start = std::chrono::steady_clock::now();
+        attempt_active = true;
+        attempt_responded = false;
+        proxy.balancer->on_start(peer);
+    }
+
+    auto respond_attempt_unsafe(bool success) -> void {
+        if(!attempt_active || attempt_responded) {
+            return;
+        }
+        attempt_responded = true;
+        hedge_timer.cancel();
+        const auto now = std::chrono::steady_clock::now();
+        proxy.balancer->on_response(peer, std::chrono::duration_cast<std::chrono::microseconds>(now - attempt_start));
+        // Errors usually come fast and would shorten the delay, adopted hedges would report the
+        // time since the hedge only.
+        if(success && hedgeable && !request_sampled) {
+            request_sampled = true;
+            proxy.hedging.sample(std::chrono::duration_cast<std::chrono::microseconds>(now - request_start));
+        }
+    }
+
+    auto finish_attempt_unsafe() -> void {
+        if(!attempt_active) {
+            return;
+        }
+        attempt_active = false;
+        proxy.balancer->on_finish(peer);
+    }
+
+    /// Tells whether a response frame belongs to the current attempt. The first response during
+    /// hedging decides the race, the other attempt is abandoned.
+    auto accept_unsafe(bool second) -> bool {
+        if(second == swapped) {
+            if(hedging) {
+                abandon_hedge_unsafe();
+            }
+            return true;
+        }
+        if(!hedging) {
+            // Late frame from an attempt which has lost the race.
+            return false;
+        }
+        adopt_hedge_unsafe();
+        proxy.hedging.won();
+        return true;
+    }
+
+    /// Tells whether an error should be handled as the error of the request. While hedging, a failure
+    /// of either attempt just leaves the other one to complete the request.
+    auto accept_error_unsafe(bool second, const std::error_code& ec, const std::string& msg) -> bool {
+        if(!hedging) {
+            return second == swapped;
+        }
+        if(second == swapped) {
+            COCAINE_LOG_INFO(logger, "current attempt failed, falling back to the hedged one");
+            respond_attempt_unsafe(false);
+            proxy.balancer->on_error(peer, ec, msg);
+            adopt_hedge_unsafe();
+        } else {
+            COCAINE_LOG_INFO(logger, "hedged attempt to {} failed", hedge.peer->uuid());
+            proxy.balancer->on_error(hedge.peer, ec, msg);
+            proxy.balancer->on_finish(hedge.peer);
+            hedging = false;
+            hedge.peer = nullptr;
+            hedge.forward_stream = safe_stream_t();
+        }
+        return false;
+    }
+
+    auto schedule_hedge_unsafe() -> void {
+        if(!hedgeable) {
+            return;
+        }
+        std::weak_ptr<vicodyn_dispatch_t> weak_self(shared_from_this());
+        hedge_timer.expires_from_now(boost::posix_time::microseconds(proxy.hedging.delay().count()));
+        hedge_timer.async_wait([=](const std::error_code& ec) {
+            auto self = weak_self.lock();
+            if(!ec && self) {
+                self->on_hedge_timer();
+            }
+        });
+    }
+
+    /// Duplicates the fully received request to another peer, if nothing has responded yet.
+    auto hedge_unsafe() -> void {
+        if(hedging || !attempt_active || attempt_responded || !buffering_enabled || !choke_sent) {
+            return;
+        }
+        std::shared_ptr<peer_t> candidate;
+        try {
+            candidate = proxy.balancer->choose_peer(request_context, enqueue_headers, enqueue_frame);
+        } catch(const std::exception& e) {
+            COCAINE_LOG_DEBUG(logger, "no peer to hedge to - {}", e.what());
+            return;
+        }
+        if(candidate == peer) {
+            COCAINE_LOG_DEBUG(logger, "no other peer to hedge to");
+            return;
+        }
+        if(!proxy.hedging.acquire()) {
+            COCAINE_LOG_DEBUG(logger, "hedging budget is exhausted");
+            return;
+        }
+        try {
+            request_context->mark_used_peer(candidate);
+            auto u = candidate->open_stream<io::node::enqueue>(hedge.origin, shared_hedge_dispatch(),
+                                                               enqueue_headers, proxy.app_name, enqueue_frame);
+            safe_stream_t stream(std::move(u));
+            for(const auto& chunk : retry_buffer.chunks()) {
+                stream.chunk(chunk.headers, *chunk.data);
+            }
+            stream.close(choke_headers);
+
+            hedge.peer = std::move(candidate);
+            hedge.forward_stream = std::move(stream);
+            hedge.start = std::chrono::steady_clock::now();
+            hedging = true;
+            proxy.hedging.sent();
+            proxy.balancer->on_start(hedge.peer);
+            COCAINE_LOG_INFO(logger, "hedged request to {}", hedge.peer->uuid());
+            request_context->add_checkpoint("hedge");
+        } catch(const std::exception& e) {
+            COCAINE_LOG_WARNING(logger, "failed to send hedged request - {}", e.what());
+            proxy.hedging.refund();
+        }
+    }
+
+    /// Makes the hedged attempt the current one.
+    ///
+    /// The request has been fully sent to both peers by now, so there is no way to cancel the other
+    /// attempt. It runs to completion on its worker, while its frames are just dropped.
+    auto adopt_hedge_unsafe() -> void {
+        finish_attempt_unsafe();
+        peer = std::move(hedge.peer);
+        origin = hedge.origin;
+        forward_stream = std::move(hedge.forward_stream);
+        hedge.forward_stream = safe_stream_t();
+        attempt_start = hedge.start;
+        attempt_active = true;
+        attempt_responded = false;
+        hedging = false;
+        swapped = !swapped;
+        logger.reset(new blackhole::wrapper_t(*proxy.logger, {{"peer", peer->uuid()}}));
+    }
+
+    /// Forgets the hedged attempt, which runs to completion on its worker nevertheless.
+    auto abandon_hedge_unsafe() -> void {
+        proxy.balancer->on_finish(hedge.peer);
+        hedging = false;
+        hedge.peer = nullptr;
+        hedge.forward_stream = safe_stream_t();
+    }
+
     auto disable_buffering_unsafe() -> void {
         buffering_enabled = false;
         enqueue_frame.clear();
         enqueue_headers.clear();
-        chunk_headers.clear();
-        chunks.clear();
+        retry_buffer.clear();
         COCAINE_LOG_DEBUG(logger, "disabled buffering");
     }
 
@@ -367,13 +627,21 @@ private:
         COCAINE_LOG_DEBUG(logger, "processing enqueue");
         enqueue_frame = std::move(event);
         enqueue_headers = std::move(headers);
+        hedgeable = proxy.hedging.enabled(enqueue_frame);
+        if(hedgeable) {
+            proxy.hedging.admit();
+        }
+        request_start = std::chrono::steady_clock::now();
         try {
-            auto u = peer->open_stream<io::node::enqueue>(shared_backward_dispatch(), enqueue_headers, proxy.app_name, enqueue_frame);
+            auto u = peer->open_stream<io::node::enqueue>(origin, shared_backward_dispatch(), enqueue_headers,
+                                                          proxy.app_name, enqueue_frame);
             forward_stream = safe_stream_t(std::move(u));
+            start_attempt_unsafe();
+            schedule_hedge_unsafe();
             request_context->add_checkpoint("after_enqueue");
         } catch (const std::system_error& e) {
+            // The failed session, if any, has been scheduled for reconnection by the peer.
             COCAINE_LOG_WARNING(logger, "failed to send enqueue to forward stream - {}", error::to_string(e));
-            peer->schedule_reconnect();
             //TODO: maybe cycle here?
             try {
                 retry_unsafe();
@@ -395,14 +663,17 @@ private:
         if(request_context->retry_count() > proxy.balancer->retry_count()) {
             throw error_t("maximum number of retries reached");
         }
+        finish_attempt_unsafe();
         peer = proxy.balancer->choose_peer(request_context, enqueue_headers, enqueue_frame);
         request_context->add_checkpoint("retry");
         request_context->mark_used_peer(peer);
         logger.reset(new blackhole::wrapper_t(*proxy.logger, {{"peer", peer->uuid()}}));
-        auto u = peer->open_stream<io::node::enqueue>(shared_backward_dispatch(), enqueue_headers, proxy.app_name, enqueue_frame);
+        auto u = peer->open_stream<io::node::enqueue>(origin, shared_backward_dispatch(), enqueue_headers,
+                                                      proxy.app_name, enqueue_frame);
         forward_stream = safe_stream_t(std::move(u));
-        for(size_t i = 0; i < chunks.size(); i++) {
-            forward_stream.chunk(chunk_headers[i], chunks[i]);
+        start_attempt_unsafe();
+        for(const auto& chunk : retry_buffer.chunks()) {
+            forward_stream.chunk(chunk.headers, *chunk.data);
         }
         if(choke_sent) {
             forward_stream.close(choke_headers);
@@ -419,14 +690,16 @@ auto proxy_t::make_balancer(const dynamic_t& args, const dynamic_t::object_t& ex
                                                               balancer_args, extra);
 }
 
-proxy_t::proxy_t(context_t& context, asio::io_service& loop, peers_t& peers, const std::string& name, const dynamic_t& args,
-                 const dynamic_t::object_t& extra) :
+proxy_t::proxy_t(context_t& context, asio::io_service& loop, peers_t& peers, std::shared_ptr<retry_budget_t> retry_budget,
+                 const std::string& name, const dynamic_t& args, const dynamic_t::object_t& extra) :
     dispatch(name),
     context(context),
     loop(loop),
     peers(peers),
+    retry_budget(std::move(retry_budget)),
     app_name(name.substr(sizeof("virtual::") - 1)),
     balancer(make_balancer(args, extra)),
+    hedging(args.as_object().at("hedging", dynamic_t::empty_object).as_object().at(app_name, dynamic_t::empty_object)),
     logger(context.log(name))
 {
     COCAINE_LOG_DEBUG(logger, "created proxy for app {}", app_name);
@@ -457,6 +730,10 @@ auto proxy_t::empty() -> bool {
     });
 }
 
+auto proxy_t::hedging_info() -> dynamic_t {
+    return hedging.info();
+}
+
 auto proxy_t::size() -> size_t {
     return peers.apply_shared([&](const peers_t::data_t& data) -> size_t {
         auto it = data.apps.find(app_name);
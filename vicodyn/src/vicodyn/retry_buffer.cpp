@@ -0,0 +1,75 @@
+#include "cocaine/vicodyn/retry_buffer.hpp"
+
+#include <cocaine/context.hpp>
+
+#include <metrics/registry.hpp>
+
+namespace cocaine {
+namespace vicodyn {
+
+retry_budget_t::retry_budget_t(context_t& context, const dynamic_t& args) :
+    request_limit(args.as_object().at("request_limit", 8u * 1024 * 1024).as_uint()),
+    global_limit(args.as_object().at("global_limit", 512u * 1024 * 1024).as_uint()),
+    used(0),
+    stats{
+        context.metrics_hub().counter<std::int64_t>("vicodyn.retry_buffer.buffered"),
+        context.metrics_hub().counter<std::int64_t>("vicodyn.retry_buffer.overflows")
+    }
+{}
+
+auto retry_budget_t::limit() const -> std::size_t {
+    return request_limit;
+}
+
+auto retry_budget_t::acquire(std::size_t size) -> bool {
+    auto current = used.load();
+    do {
+        if(current + size > global_limit) {
+            return false;
+        }
+    } while(!used.compare_exchange_weak(current, current + size));
+
+    stats.buffered->fetch_add(static_cast<std::int64_t>(size));
+    return true;
+}
+
+auto retry_budget_t::release(std::size_t size) -> void {
+    used.fetch_sub(size);
+    stats.buffered->fetch_sub(static_cast<std::int64_t>(size));
+}
+
+auto retry_budget_t::overflow() -> void {
+    stats.overflows->fetch_add(1);
+}
+
+retry_buffer_t::retry_buffer_t(std::shared_ptr<retry_budget_t> budget) :
+    budget(std::move(budget)),
+    size(0)
+{}
+
+retry_buffer_t::~retry_buffer_t() {
+    clear();
+}
+
+auto retry_buffer_t::push(const hpack::headers_t& headers, std::shared_ptr<const std::string> data) -> bool {
+    if(size + data->size() > budget->limit() || !budget->acquire(data->size())) {
+        budget->overflow();
+        return false;
+    }
+    size += data->size();
+    buffered.push_back(chunk_t{headers, std::move(data)});
+    return true;
+}
+
+auto retry_buffer_t::chunks() const -> const std::vector<chunk_t>& {
+    return buffered;
+}
+
+auto retry_buffer_t::clear() -> void {
+    budget->release(size);
+    size = 0;
+    buffered.clear();
+}
+
+} // namespace vicodyn
+} // namespace cocaine
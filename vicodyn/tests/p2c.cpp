@@ -0,0 +1,114 @@
+#include "cocaine/vicodyn/balancer/p2c.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace testing {
+
+using cocaine::vicodyn::balancer::p2c_t;
+
+namespace {
+
+/// Discrete time simulation of the power of two choices selection over peers with the given
+/// response latencies in ticks, returns the number of requests sent to each peer.
+auto simulate(const std::vector<int>& latencies, int ticks, int rate) -> std::vector<int> {
+    const auto initial = std::chrono::milliseconds(10);
+    const auto decay = std::chrono::seconds(10);
+    // One tick is worth a millisecond of latency.
+    const auto tick = std::chrono::milliseconds(1);
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> pick(0, latencies.size() - 1);
+
+    std::vector<std::shared_ptr<p2c_t::stats_t>> stats;
+    for(size_t i = 0; i < latencies.size(); ++i) {
+        stats.push_back(std::make_shared<p2c_t::stats_t>());
+    }
+
+    std::vector<int> shares(latencies.size(), 0);
+    std::multimap<int, size_t> pending;
+
+    for(int now = 0; now < ticks; ++now) {
+        for(auto it = pending.begin(); it != pending.end() && it->first <= now; it = pending.erase(it)) {
+            const auto peer = it->second;
+            stats[peer]->sample(tick * latencies[peer], decay);
+            stats[peer]->finish();
+        }
+
+        for(int i = 0; i < rate; ++i) {
+            const auto first = pick(random);
+            auto second = pick(random);
+            while(second == first) {
+                second = pick(random);
+            }
+
+            const auto peer = stats[second]->cost(initial) < stats[first]->cost(initial) ? second : first;
+            stats[peer]->start();
+            pending.emplace(now + latencies[peer], peer);
+            ++shares[peer];
+        }
+    }
+
+    return shares;
+}
+
+} // namespace
+
+TEST(p2c, stats_cost_grows_with_outstanding_requests) {
+    p2c_t::stats_t stats;
+    const auto initial = std::chrono::microseconds(100);
+
+    const auto idle = stats.cost(initial);
+    EXPECT_TRUE(stats.idle());
+
+    stats.start();
+    EXPECT_FALSE(stats.idle());
+    EXPECT_GT(stats.cost(initial), idle);
+
+    stats.finish();
+    EXPECT_TRUE(stats.idle());
+    EXPECT_EQ(idle, stats.cost(initial));
+
+    // Never goes below zero.
+    stats.finish();
+    EXPECT_TRUE(stats.idle());
+}
+
+TEST(p2c, stats_take_latency_peaks_at_once) {
+    p2c_t::stats_t stats;
+    const auto initial = std::chrono::microseconds(100);
+    const auto decay = std::chrono::seconds(10);
+
+    stats.sample(std::chrono::microseconds(10), decay);
+    const auto fast = stats.cost(initial);
+
+    stats.sample(std::chrono::microseconds(1000), decay);
+    EXPECT_EQ(1001, stats.cost(initial));
+    EXPECT_GT(stats.cost(initial), fast);
+
+    // A recovery is smoothed over the decay interval.
+    stats.sample(std::chrono::microseconds(10), decay);
+    EXPECT_GT(stats.cost(initial), 900);
+}
+
+TEST(p2c, spreads_load_between_equal_peers) {
+    const auto shares = simulate({5, 5, 5, 5, 5}, 2000, 2);
+
+    for(const auto share : shares) {
+        EXPECT_GT(share, 4000 / 5 / 2);
+    }
+}
+
+TEST(p2c, avoids_slow_peer) {
+    const auto shares = simulate({50, 5, 5, 5, 5}, 2000, 2);
+
+    // With uniform selection the slow peer would receive a fifth of all requests.
+    EXPECT_LT(shares[0], 4000 / 20);
+}
+
+} // namespace testing